@@ -0,0 +1,98 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_BUDGET_H
+#define __MONITOR_BUDGET_H
+
+// Deliberately free of framework dependencies, so the tests can exercise it on their own.
+#include <algorithm>
+#include <cstdint>
+
+namespace Thunder {
+namespace Plugin {
+
+    // System wide memory budget, all values in bytes. A plugin suspended to meet the budget frees memory
+    // that it claims again once resumed. Resuming it as soon as the budget is met would exceed it again, so
+    // the budget is only considered met again once the usage dropped the headroom below it.
+    class BudgetType {
+    public:
+        BudgetType(const BudgetType&) = default;
+        BudgetType& operator=(const BudgetType&) = default;
+
+        BudgetType()
+            : _limit(0)
+            , _reserve(0)
+            , _headroom(0)
+        {
+        }
+        BudgetType(const uint64_t limit, const uint64_t reserve, const uint64_t headroom)
+            : _limit(limit)
+            , _reserve(reserve)
+            , _headroom(headroom)
+        {
+        }
+        ~BudgetType() = default;
+
+    public:
+        inline uint64_t Limit() const
+        {
+            return (_limit);
+        }
+        inline uint64_t Reserve() const
+        {
+            return (_reserve);
+        }
+        inline uint64_t Headroom() const
+        {
+            return (_headroom);
+        }
+        inline bool IsSet() const
+        {
+            return ((_limit != 0) || (_reserve != 0));
+        }
+        // How much memory has to be given up to meet the budget.
+        uint64_t Excess(const uint64_t total, const uint64_t available) const
+        {
+            uint64_t result = 0;
+
+            if ((_limit != 0) && (total > _limit)) {
+                result = total - _limit;
+            }
+            if ((_reserve != 0) && (available < _reserve)) {
+                result = std::max(result, _reserve - available);
+            }
+
+            return (result);
+        }
+        // Whether what was given up for the budget may be claimed again.
+        bool Met(const uint64_t total, const uint64_t available) const
+        {
+            return (((_limit == 0) || ((total < _limit) && ((_limit - total) >= _headroom))) && ((_reserve == 0) || ((available >= _reserve) && ((available - _reserve) >= _headroom))));
+        }
+
+    private:
+        uint64_t _limit; //!< Total resident memory all observees together may use, 0 if unlimited.
+        uint64_t _reserve; //!< Memory the system should keep available, 0 if not checked.
+        uint64_t _headroom; //!< How far the usage has to drop below the budget before it is met again.
+    };
+
+} // namespace Plugin
+} // namespace Thunder
+
+#endif // __MONITOR_BUDGET_H
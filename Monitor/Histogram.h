@@ -0,0 +1,144 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_HISTOGRAM_H
+#define __MONITOR_HISTOGRAM_H
+
+// Deliberately free of framework dependencies, so the tests can exercise it on their own.
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace Thunder {
+namespace Plugin {
+
+    // Log bucketed (HDR like) histogram. Values below 2^SubBucketBits are counted exactly, above that every
+    // power of two is split in 2^SubBucketBits buckets, so the reported percentiles are within 6.25% of the
+    // real value, at a fixed memory footprint independent of the number of measurements.
+    // All histograms of a TYPE share the bucket layout, so the histograms of separate intervals can be merged
+    // without losing precision.
+    template <typename TYPE>
+    class HistogramType {
+    private:
+        static constexpr uint8_t SubBucketBits = 3;
+        static constexpr uint8_t SubBuckets = (1 << SubBucketBits);
+        static constexpr uint16_t Buckets = static_cast<uint16_t>(((sizeof(TYPE) * 8) - SubBucketBits + 1) << SubBucketBits);
+
+    public:
+        HistogramType()
+            : _count(0)
+            , _buckets()
+        {
+        }
+        HistogramType(const HistogramType& copy) = default;
+        HistogramType& operator=(const HistogramType& rhs) = default;
+        ~HistogramType() = default;
+
+    public:
+        inline void Set(const TYPE value)
+        {
+            _buckets[Index(value)]++;
+            _count++;
+        }
+        inline void Reset()
+        {
+            _buckets.fill(0);
+            _count = 0;
+        }
+        inline void Merge(const HistogramType& other)
+        {
+            for (uint16_t index = 0; index < Buckets; index++) {
+                _buckets[index] += other._buckets[index];
+            }
+            _count += other._count;
+        }
+        inline uint32_t Measurements() const
+        {
+            return (_count);
+        }
+        // The value below which the given part (in 1/10000) of the measurements fall, anything above 10000
+        // is taken as the maximum.
+        TYPE Percentile(const uint16_t permyriad) const
+        {
+            TYPE result = 0;
+
+            if (_count != 0) {
+                uint64_t target = std::max(((static_cast<uint64_t>(_count) * std::min(permyriad, static_cast<uint16_t>(10000))) + 9999) / 10000, static_cast<uint64_t>(1));
+                uint64_t seen = _buckets[0];
+                uint16_t index = 0;
+
+                while ((seen < target) && (index < (Buckets - 1))) {
+                    seen += _buckets[++index];
+                }
+
+                result = Value(index);
+            }
+
+            return (result);
+        }
+
+    private:
+        static uint8_t MostSignificantBit(const TYPE value)
+        {
+            uint64_t remainder = value;
+            uint8_t result = 0;
+
+            for (uint8_t shift = 32; shift != 0; shift >>= 1) {
+                if ((remainder >> shift) != 0) {
+                    remainder >>= shift;
+                    result += shift;
+                }
+            }
+
+            return (result);
+        }
+        static uint16_t Index(const TYPE value)
+        {
+            uint16_t result = static_cast<uint16_t>(value);
+
+            if (value >= SubBuckets) {
+                const uint8_t msb = MostSignificantBit(value);
+                result = static_cast<uint16_t>(((msb - SubBucketBits + 1) << SubBucketBits) | ((value >> (msb - SubBucketBits)) & (SubBuckets - 1)));
+            }
+
+            return (result);
+        }
+        static TYPE Value(const uint16_t index)
+        {
+            TYPE result = static_cast<TYPE>(index);
+
+            if (index >= SubBuckets) {
+                // Report the middle of the bucket.
+                const uint8_t shift = static_cast<uint8_t>((index >> SubBucketBits) - 1);
+                const uint64_t lower = static_cast<uint64_t>(SubBuckets | (index & (SubBuckets - 1))) << shift;
+                result = static_cast<TYPE>(lower + ((static_cast<uint64_t>(1) << shift) >> 1));
+            }
+
+            return (result);
+        }
+
+    private:
+        uint32_t _count;
+        std::array<uint32_t, Buckets> _buckets;
+    };
+
+} // namespace Plugin
+} // namespace Thunder
+
+#endif // __MONITOR_HISTOGRAM_H
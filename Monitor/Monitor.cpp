@@ -39,6 +39,7 @@ namespace Plugin {
     static Core::ProxyPoolType<Web::JSONBodyType<Core::JSON::ArrayType<Monitor::Data>>> jsonBodyDataFactory(2);
     static Core::ProxyPoolType<Web::JSONBodyType<Monitor::Data>> jsonBodyParamFactory(2);
     static Core::ProxyPoolType<Web::JSONBodyType<Monitor::Data::MetaData>> jsonMemoryBodyDataFactory(2);
+    static Core::ProxyPoolType<Web::TextBody> textBodyFactory(2);
 
     /* virtual */ const string Monitor::Initialize(PluginHost::IShell* service)
     {
@@ -51,7 +52,7 @@ namespace Plugin {
         Core::JSON::ArrayType<Config::Entry>::Iterator index(_config.Observables.Elements());
 
         // Create a list of plugins to monitor..
-        _monitor.Open(service, index);
+        _monitor.Open(service, _config.Budget, index);
 
         // During the registartion, all Plugins, currently active are reported to the sink.
         service->Register(&_monitor);
@@ -86,6 +87,7 @@ namespace Plugin {
     }
 
     // <GET> ../				Get all Memory Measurments
+    // <GET> ../metrics		Get all Measurements in the Prometheus text format (an observee called metrics takes precedence)
     // <GET> ../<Callsign>		Get the Memory Measurements for Callsign
     // <PUT> ../<Callsign>		Reset the Memory measurements for Callsign
     /* virtual */ Core::ProxyType<Web::Response> Monitor::Process(const Web::Request& request)
@@ -112,6 +114,15 @@ namespace Plugin {
 
                     result->Body(Core::ProxyType<Web::IBody>(response));
                 }
+
+                result->ContentType = Web::MIME_JSON;
+            } else if ((index.Current() == _T("metrics")) && (_monitor.IsObserved(index.Current().Text()) == false)) {
+                Core::ProxyType<Web::TextBody> response(textBodyFactory.Element());
+
+                _monitor.Metrics(static_cast<string&>(*response));
+
+                result->Body(Core::ProxyType<Web::IBody>(response));
+                result->ContentType = Web::MIME_TEXT;
             } else {
                 MetaData memoryInfo;
                 bool operational = false;
@@ -124,9 +135,9 @@ namespace Plugin {
 
                     result->Body(Core::ProxyType<Web::IBody>(response));
                 }
-            }
 
-            result->ContentType = Web::MIME_JSON;
+                result->ContentType = Web::MIME_JSON;
+            }
         } else if ((request.Verb == Web::Request::HTTP_PUT) && (index.Next() == true)) {
             MetaData memoryInfo;
             bool operational = false;
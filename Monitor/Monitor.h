@@ -21,15 +21,22 @@
 #define __MONITOR_H
 
 #include "Module.h"
+#include "Budget.h"
+#include "Histogram.h"
+#include "Schedule.h"
+#include <interfaces/IBrowser.h>
 #include <interfaces/IMemory.h>
 #include <interfaces/json/JsonData_Monitor.h>
+#include <algorithm>
+#include <array>
+#include <deque>
 #include <limits>
 #include <string>
+#include <vector>
 
-static uint32_t gcd(uint32_t a, uint32_t b)
-{
-    return b == 0 ? a : gcd(b, a % b);
-}
+#ifndef __WINDOWS__
+#include <dirent.h>
+#endif
 
 namespace Thunder {
 namespace Plugin {
@@ -62,7 +69,135 @@ namespace Plugin {
             Core::JSON::DecUInt8 Limit;
         };
 
+        class AdaptiveInfo : public Core::JSON::Container {
+        public:
+            AdaptiveInfo& operator=(const AdaptiveInfo&) = delete;
+
+            AdaptiveInfo()
+                : Core::JSON::Container()
+            {
+                Add(_T("min"), &Min);
+                Add(_T("max"), &Max);
+            }
+            AdaptiveInfo(const AdaptiveInfo& copy)
+                : Core::JSON::Container()
+                , Min(copy.Min)
+                , Max(copy.Max)
+            {
+                Add(_T("min"), &Min);
+                Add(_T("max"), &Max);
+            }
+            ~AdaptiveInfo() override
+            {
+            }
+
+            Core::JSON::DecUInt32 Min;
+            Core::JSON::DecUInt32 Max;
+        };
+
+        class EscalationInfo : public Core::JSON::Container {
+        public:
+            EscalationInfo& operator=(const EscalationInfo&) = delete;
+
+            EscalationInfo()
+                : Core::JSON::Container()
+                , Reclaim(false)
+                , Suspend(false)
+                , Grace(0)
+            {
+                Add(_T("reclaim"), &Reclaim);
+                Add(_T("suspend"), &Suspend);
+                Add(_T("grace"), &Grace);
+            }
+            EscalationInfo(const EscalationInfo& copy)
+                : Core::JSON::Container()
+                , Reclaim(copy.Reclaim)
+                , Suspend(copy.Suspend)
+                , Grace(copy.Grace)
+            {
+                Add(_T("reclaim"), &Reclaim);
+                Add(_T("suspend"), &Suspend);
+                Add(_T("grace"), &Grace);
+            }
+            ~EscalationInfo() override
+            {
+            }
+
+            Core::JSON::Boolean Reclaim;
+            Core::JSON::Boolean Suspend;
+            Core::JSON::DecUInt16 Grace;
+        };
+
+        class BackoffInfo : public Core::JSON::Container {
+        public:
+            BackoffInfo& operator=(const BackoffInfo&) = delete;
+
+            BackoffInfo()
+                : Core::JSON::Container()
+                , Delay(0)
+                , Window(0)
+                , Limit(0)
+            {
+                Add(_T("delay"), &Delay);
+                Add(_T("window"), &Window);
+                Add(_T("limit"), &Limit);
+            }
+            BackoffInfo(const BackoffInfo& copy)
+                : Core::JSON::Container()
+                , Delay(copy.Delay)
+                , Window(copy.Window)
+                , Limit(copy.Limit)
+            {
+                Add(_T("delay"), &Delay);
+                Add(_T("window"), &Window);
+                Add(_T("limit"), &Limit);
+            }
+            ~BackoffInfo() override
+            {
+            }
+
+            Core::JSON::DecUInt16 Delay;
+            Core::JSON::DecUInt32 Window;
+            Core::JSON::DecUInt8 Limit;
+        };
+
+        class BudgetInfo : public Core::JSON::Container {
+        public:
+            BudgetInfo& operator=(const BudgetInfo&) = delete;
+
+            BudgetInfo()
+                : Core::JSON::Container()
+                , Limit(0)
+                , Reserve(0)
+                , Headroom(0)
+            {
+                Add(_T("limit"), &Limit);
+                Add(_T("reserve"), &Reserve);
+                Add(_T("headroom"), &Headroom);
+            }
+            BudgetInfo(const BudgetInfo& copy)
+                : Core::JSON::Container()
+                , Limit(copy.Limit)
+                , Reserve(copy.Reserve)
+                , Headroom(copy.Headroom)
+            {
+                Add(_T("limit"), &Limit);
+                Add(_T("reserve"), &Reserve);
+                Add(_T("headroom"), &Headroom);
+            }
+            ~BudgetInfo() override
+            {
+            }
+
+            Core::JSON::DecUInt32 Limit;
+            Core::JSON::DecUInt32 Reserve;
+            Core::JSON::DecUInt32 Headroom;
+        };
+
     public:
+        template <typename TYPE>
+        using Histogram = HistogramType<TYPE>;
+
         class MetaData {
         public:
             MetaData()
@@ -70,6 +205,14 @@ namespace Plugin {
                 , _allocated()
                 , _shared()
                 , _process()
+                , _descriptors()
+                , _threads()
+                , _residentHistogram()
+                , _allocatedHistogram()
+                , _sharedHistogram()
+                , _processHistogram()
+                , _descriptorsHistogram()
+                , _threadsHistogram()
             {
             }
             MetaData(const MetaData& copy)
@@ -77,6 +220,14 @@ namespace Plugin {
                 , _allocated(copy._allocated)
                 , _shared(copy._shared)
                 , _process(copy._process)
+                , _descriptors(copy._descriptors)
+                , _threads(copy._threads)
+                , _residentHistogram(copy._residentHistogram)
+                , _allocatedHistogram(copy._allocatedHistogram)
+                , _sharedHistogram(copy._sharedHistogram)
+                , _processHistogram(copy._processHistogram)
+                , _descriptorsHistogram(copy._descriptorsHistogram)
+                , _threadsHistogram(copy._threadsHistogram)
             {
             }
             ~MetaData()
@@ -89,13 +240,24 @@ namespace Plugin {
                 _allocated = rhs._allocated;
                 _shared = rhs._shared;
                 _process = rhs._process;
+                _descriptors = rhs._descriptors;
+                _threads = rhs._threads;
+                _residentHistogram = rhs._residentHistogram;
+                _allocatedHistogram = rhs._allocatedHistogram;
+                _sharedHistogram = rhs._sharedHistogram;
+                _processHistogram = rhs._processHistogram;
+                _descriptorsHistogram = rhs._descriptorsHistogram;
+                _threadsHistogram = rhs._threadsHistogram;
 
                 return (*this);
             }
 
         public:
             bool HasMeasurements() const {
-                return ((_resident.Measurements() != 0) || (_allocated.Measurements() != 0) || (_shared.Measurements() != 0) || (_process.Measurements() != 0));
+                return ((_resident.Measurements() != 0) || (_allocated.Measurements() != 0) || (_shared.Measurements() != 0) || (_process.Measurements() != 0) || (_descriptors.Measurements() != 0) || (_threads.Measurements() != 0));
+            }
+            bool HasResources() const {
+                return ((_descriptors.Measurements() != 0) || (_threads.Measurements() != 0));
             }
 
             void AddMeasurements(const uint64_t resident, const uint64_t allocated, const uint64_t shared, const uint8_t process) {
@@ -103,15 +265,22 @@ namespace Plugin {
                 _allocated.Set(allocated);
                 _shared.Set(shared);
                 _process.Set(process);
+                _residentHistogram.Set(resident);
+                _allocatedHistogram.Set(allocated);
+                _sharedHistogram.Set(shared);
+                _processHistogram.Set(process);
+            }
+            void AddResources(const uint32_t descriptors, const uint32_t threads) {
+                _descriptors.Set(descriptors);
+                _threads.Set(threads);
+                _descriptorsHistogram.Set(descriptors);
+                _threadsHistogram.Set(threads);
             }
 
             void Measure(Exchange::IMemory* memInterface)
             {
                 ASSERT(memInterface != nullptr);
-                _resident.Set(memInterface->Resident());
-                _allocated.Set(memInterface->Allocated());
-                _shared.Set(memInterface->Shared());
-                _process.Set(memInterface->Processes());
+                AddMeasurements(memInterface->Resident(), memInterface->Allocated(), memInterface->Shared(), memInterface->Processes());
             }
             void Reset()
             {
@@ -119,6 +288,14 @@ namespace Plugin {
                 _allocated.Reset();
                 _shared.Reset();
                 _process.Reset();
+                _descriptors.Reset();
+                _threads.Reset();
+                _residentHistogram.Reset();
+                _allocatedHistogram.Reset();
+                _sharedHistogram.Reset();
+                _processHistogram.Reset();
+                _descriptorsHistogram.Reset();
+                _threadsHistogram.Reset();
             }
 
         public:
@@ -138,11 +315,309 @@ namespace Plugin {
             {
                 return (_process);
             }
+            inline const Core::MeasurementType<uint32_t>& Descriptors() const
+            {
+                return (_descriptors);
+            }
+            inline const Core::MeasurementType<uint32_t>& Threads() const
+            {
+                return (_threads);
+            }
+            inline const Histogram<uint64_t>& ResidentHistogram() const
+            {
+                return (_residentHistogram);
+            }
+            inline const Histogram<uint64_t>& AllocatedHistogram() const
+            {
+                return (_allocatedHistogram);
+            }
+            inline const Histogram<uint64_t>& SharedHistogram() const
+            {
+                return (_sharedHistogram);
+            }
+            inline const Histogram<uint8_t>& ProcessHistogram() const
+            {
+                return (_processHistogram);
+            }
+            inline const Histogram<uint32_t>& DescriptorsHistogram() const
+            {
+                return (_descriptorsHistogram);
+            }
+            inline const Histogram<uint32_t>& ThreadsHistogram() const
+            {
+                return (_threadsHistogram);
+            }
         private:
             Core::MeasurementType<uint64_t> _resident;
             Core::MeasurementType<uint64_t> _allocated;
             Core::MeasurementType<uint64_t> _shared;
             Core::MeasurementType<uint8_t> _process;
+            Core::MeasurementType<uint32_t> _descriptors;
+            Core::MeasurementType<uint32_t> _threads;
+            Histogram<uint64_t> _residentHistogram;
+            Histogram<uint64_t> _allocatedHistogram;
+            Histogram<uint64_t> _sharedHistogram;
+            Histogram<uint8_t> _processHistogram;
+            Histogram<uint32_t> _descriptorsHistogram;
+            Histogram<uint32_t> _threadsHistogram;
+        };
+
+        // Append-only log of the failures the Monitor acted upon. It is persisted, so a plugin that keeps
+        // failing across framework restarts or reboots is still recognized. Every line holds the time, the
+        // callsign, the reason, the action taken and the memory measured at the time of the failure.
+        class RestartLog {
+        public:
+            // Beyond this the oldest entries are dropped and the file is rewritten.
+            static constexpr uint16_t Capacity = 256;
+
+            struct Entry {
+                uint64_t Time; // seconds since the epoch
+                string Callsign;
+                string Reason;
+                string Action;
+                uint64_t Resident;
+                uint64_t Allocated;
+                uint64_t Shared;
+                uint8_t Processes;
+            };
+
+        public:
+            RestartLog(const RestartLog&) = delete;
+            RestartLog& operator=(const RestartLog&) = delete;
+
+            RestartLog()
+                : _fileName()
+                , _entries()
+                , _appended(0)
+                , _adminLock()
+            {
+            }
+            ~RestartLog() = default;
+
+        public:
+            void Open(const string& fileName)
+            {
+                _adminLock.Lock();
+
+                _fileName = fileName;
+                _entries.clear();
+
+                FILE* file = fopen(_fileName.c_str(), "r");
+
+                if (file != nullptr) {
+                    char line[256];
+                    uint32_t lines = 0;
+
+                    while (fgets(line, sizeof(line), file) != nullptr) {
+                        Entry entry;
+
+                        if (Parse(line, entry) == true) {
+                            _entries.push_back(std::move(entry));
+
+                            if (_entries.size() > Capacity) {
+                                _entries.pop_front();
+                            }
+                        }
+                        lines++;
+                    }
+
+                    fclose(file);
+
+                    if (lines != _entries.size()) {
+                        Compact();
+                    }
+                }
+
+                _appended = 0;
+
+                _adminLock.Unlock();
+            }
+            void Close()
+            {
+                _adminLock.Lock();
+                _entries.clear();
+                _fileName.clear();
+                _adminLock.Unlock();
+            }
+            void Add(const Entry& entry)
+            {
+                _adminLock.Lock();
+
+                _entries.push_back(entry);
+
+                if (_entries.size() > Capacity) {
+                    _entries.pop_front();
+                }
+
+                if (_fileName.empty() == false) {
+                    if (++_appended >= Capacity) {
+                        Compact();
+                    } else {
+                        FILE* file = fopen(_fileName.c_str(), "a");
+
+                        if (file != nullptr) {
+                            Write(file, entry);
+                            fclose(file);
+                        }
+                    }
+                }
+
+                _adminLock.Unlock();
+            }
+            // Number of failures of the given callsign logged since the given time (seconds since the epoch).
+            uint32_t Failures(const string& callsign, const uint64_t since) const
+            {
+                uint32_t result = 0;
+
+                _adminLock.Lock();
+
+                for (const Entry& entry : _entries) {
+                    if ((entry.Time >= since) && (entry.Callsign == callsign)) {
+                        result++;
+                    }
+                }
+
+                _adminLock.Unlock();
+
+                return (result);
+            }
+            // Visits the entries of the given callsign, or all entries if no callsign is given, oldest first.
+            template <typename ACTION>
+            void Visit(const string& callsign, ACTION&& action) const
+            {
+                _adminLock.Lock();
+
+                for (const Entry& entry : _entries) {
+                    if ((callsign.empty() == true) || (entry.Callsign == callsign)) {
+                        action(entry);
+                    }
+                }
+
+                _adminLock.Unlock();
+            }
+
+        private:
+            static bool Parse(const char line[], Entry& entry)
+            {
+                char callsign[128];
+                char reason[32];
+                char action[32];
+                unsigned long long time, resident, allocated, shared;
+                unsigned int processes;
+
+                bool result = (sscanf(line, "%llu %127s %31s %31s %llu %llu %llu %u", &time, callsign, reason, action, &resident, &allocated, &shared, &processes) == 8);
+
+                if (result == true) {
+                    entry.Time = time;
+                    entry.Callsign = callsign;
+                    entry.Reason = reason;
+                    entry.Action = action;
+                    entry.Resident = resident;
+                    entry.Allocated = allocated;
+                    entry.Shared = shared;
+                    entry.Processes = static_cast<uint8_t>(processes);
+                }
+
+                return (result);
+            }
+            static void Write(FILE* file, const Entry& entry)
+            {
+                fprintf(file, "%llu %s %s %s %llu %llu %llu %u\n",
+                    static_cast<unsigned long long>(entry.Time), entry.Callsign.c_str(), entry.Reason.c_str(), entry.Action.c_str(),
+                    static_cast<unsigned long long>(entry.Resident), static_cast<unsigned long long>(entry.Allocated),
+                    static_cast<unsigned long long>(entry.Shared), static_cast<unsigned int>(entry.Processes));
+            }
+            // Rewrite the file with what is retained, the old file is only replaced once the new one is complete.
+            void Compact()
+            {
+                const string temporary(_fileName + _T(".tmp"));
+
+                FILE* file = fopen(temporary.c_str(), "w");
+
+                if (file != nullptr) {
+                    for (const Entry& entry : _entries) {
+                        Write(file, entry);
+                    }
+
+                    if (fclose(file) == 0) {
+                        rename(temporary.c_str(), _fileName.c_str());
+                    } else {
+                        remove(temporary.c_str());
+                    }
+                }
+
+                _appended = 0;
+            }
+
+        private:
+            string _fileName;
+            std::deque<Entry> _entries;
+            uint16_t _appended;
+            mutable Core::CriticalSection _adminLock;
+        };
+
+        class History : public Core::JSON::Container {
+        public:
+            History& operator=(const History&) = delete;
+
+            History()
+                : Core::JSON::Container()
+            {
+                Init();
+            }
+            History(const RestartLog::Entry& entry)
+                : Core::JSON::Container()
+            {
+                Init();
+
+                Time = Core::Time(entry.Time * Core::Time::MicroSecondsPerSecond).ToISO8601();
+                Callsign = entry.Callsign;
+                Reason = entry.Reason;
+                Action = entry.Action;
+                Resident = entry.Resident;
+                Allocated = entry.Allocated;
+                Shared = entry.Shared;
+                Process = entry.Processes;
+            }
+            History(const History& copy)
+                : Core::JSON::Container()
+                , Time(copy.Time)
+                , Callsign(copy.Callsign)
+                , Reason(copy.Reason)
+                , Action(copy.Action)
+                , Resident(copy.Resident)
+                , Allocated(copy.Allocated)
+                , Shared(copy.Shared)
+                , Process(copy.Process)
+            {
+                Init();
+            }
+            ~History() override
+            {
+            }
+
+        private:
+            void Init()
+            {
+                Add(_T("time"), &Time);
+                Add(_T("callsign"), &Callsign);
+                Add(_T("reason"), &Reason);
+                Add(_T("action"), &Action);
+                Add(_T("resident"), &Resident);
+                Add(_T("allocated"), &Allocated);
+                Add(_T("shared"), &Shared);
+                Add(_T("process"), &Process);
+            }
+
+        public:
+            Core::JSON::String Time;
+            Core::JSON::String Callsign;
+            Core::JSON::String Reason;
+            Core::JSON::String Action;
+            Core::JSON::DecUInt64 Resident;
+            Core::JSON::DecUInt64 Allocated;
+            Core::JSON::DecUInt64 Shared;
+            Core::JSON::DecUInt8 Process;
         };
 
         class Data : public Core::JSON::Container {
@@ -158,6 +633,10 @@ namespace Plugin {
                         Add(_T("max"), &Max);
                         Add(_T("average"), &Average);
                         Add(_T("last"), &Last);
+                        Add(_T("p50"), &P50);
+                        Add(_T("p90"), &P90);
+                        Add(_T("p99"), &P99);
+                        Add(_T("p999"), &P999);
                     }
                     Measurement(const uint64_t min, const uint64_t max, const uint64_t average, const uint64_t last)
                         : Core::JSON::Container()
@@ -166,6 +645,10 @@ namespace Plugin {
                         Add(_T("max"), &Max);
                         Add(_T("average"), &Average);
                         Add(_T("last"), &Last);
+                        Add(_T("p50"), &P50);
+                        Add(_T("p90"), &P90);
+                        Add(_T("p99"), &P99);
+                        Add(_T("p999"), &P999);
 
                         Min = min;
                         Max = max;
@@ -179,6 +662,27 @@ namespace Plugin {
                         Add(_T("max"), &Max);
                         Add(_T("average"), &Average);
                         Add(_T("last"), &Last);
+                        Add(_T("p50"), &P50);
+                        Add(_T("p90"), &P90);
+                        Add(_T("p99"), &P99);
+                        Add(_T("p999"), &P999);
+
+                        Min = input.Min();
+                        Max = input.Max();
+                        Average = input.Average();
+                        Last = input.Last();
+                    }
+                    Measurement(const Core::MeasurementType<uint32_t>& input)
+                        : Core::JSON::Container()
+                    {
+                        Add(_T("min"), &Min);
+                        Add(_T("max"), &Max);
+                        Add(_T("average"), &Average);
+                        Add(_T("last"), &Last);
+                        Add(_T("p50"), &P50);
+                        Add(_T("p90"), &P90);
+                        Add(_T("p99"), &P99);
+                        Add(_T("p999"), &P999);
 
                         Min = input.Min();
                         Max = input.Max();
@@ -192,6 +696,10 @@ namespace Plugin {
                         Add(_T("max"), &Max);
                         Add(_T("average"), &Average);
                         Add(_T("last"), &Last);
+                        Add(_T("p50"), &P50);
+                        Add(_T("p90"), &P90);
+                        Add(_T("p99"), &P99);
+                        Add(_T("p999"), &P999);
 
                         Min = input.Min();
                         Max = input.Max();
@@ -204,11 +712,19 @@ namespace Plugin {
                         , Max(copy.Max)
                         , Average(copy.Average)
                         , Last(copy.Last)
+                        , P50(copy.P50)
+                        , P90(copy.P90)
+                        , P99(copy.P99)
+                        , P999(copy.P999)
                     {
                         Add(_T("min"), &Min);
                         Add(_T("max"), &Max);
                         Add(_T("average"), &Average);
                         Add(_T("last"), &Last);
+                        Add(_T("p50"), &P50);
+                        Add(_T("p90"), &P90);
+                        Add(_T("p99"), &P99);
+                        Add(_T("p999"), &P999);
                     }
                     ~Measurement()
                     {
@@ -221,6 +737,10 @@ namespace Plugin {
                         Max = RHS.Max;
                         Average = RHS.Average;
                         Last = RHS.Last;
+                        P50 = RHS.P50;
+                        P90 = RHS.P90;
+                        P99 = RHS.P99;
+                        P999 = RHS.P999;
 
                         return (*this);
                     }
@@ -233,12 +753,26 @@ namespace Plugin {
 
                         return (*this);
                     }
+                    template <typename TYPE>
+                    void Percentiles(const Monitor::Histogram<TYPE>& input)
+                    {
+                        if (input.Measurements() != 0) {
+                            P50 = input.Percentile(5000);
+                            P90 = input.Percentile(9000);
+                            P99 = input.Percentile(9900);
+                            P999 = input.Percentile(9990);
+                        }
+                    }
 
                 public:
                     Core::JSON::DecUInt64 Min;
                     Core::JSON::DecUInt64 Max;
                     Core::JSON::DecUInt64 Average;
                     Core::JSON::DecUInt64 Last;
+                    Core::JSON::DecUInt64 P50;
+                    Core::JSON::DecUInt64 P90;
+                    Core::JSON::DecUInt64 P99;
+                    Core::JSON::DecUInt64 P999;
                 };
 
             public:
@@ -248,6 +782,8 @@ namespace Plugin {
                     , Resident()
                     , Shared()
                     , Process()
+                    , Descriptors()
+                    , Threads()
                     , Operational()
                     , Count()
                 {
@@ -255,6 +791,8 @@ namespace Plugin {
                     Add(_T("resident"), &Resident);
                     Add(_T("shared"), &Shared);
                     Add(_T("process"), &Process);
+                    Add(_T("descriptors"), &Descriptors);
+                    Add(_T("threads"), &Threads);
                     Add(_T("operational"), &Operational);
                     Add(_T("count"), &Count);
                 }
@@ -265,6 +803,8 @@ namespace Plugin {
                     Add(_T("resident"), &Resident);
                     Add(_T("shared"), &Shared);
                     Add(_T("process"), &Process);
+                    Add(_T("descriptors"), &Descriptors);
+                    Add(_T("threads"), &Threads);
                     Add(_T("operational"), &Operational);
                     Add(_T("count"), &Count);
 
@@ -272,6 +812,16 @@ namespace Plugin {
                     Resident = input.Resident();
                     Shared = input.Shared();
                     Process = input.Process();
+                    Allocated.Percentiles(input.AllocatedHistogram());
+                    Resident.Percentiles(input.ResidentHistogram());
+                    Shared.Percentiles(input.SharedHistogram());
+                    Process.Percentiles(input.ProcessHistogram());
+                    if (input.HasResources() == true) {
+                        Descriptors = input.Descriptors();
+                        Threads = input.Threads();
+                        Descriptors.Percentiles(input.DescriptorsHistogram());
+                        Threads.Percentiles(input.ThreadsHistogram());
+                    }
                     Operational = operational;
                     Count = input.Allocated().Measurements();
                 }
@@ -281,6 +831,8 @@ namespace Plugin {
                     , Resident(copy.Resident)
                     , Shared(copy.Shared)
                     , Process(copy.Process)
+                    , Descriptors(copy.Descriptors)
+                    , Threads(copy.Threads)
                     , Operational(copy.Operational)
                     , Count(copy.Count)
                 {
@@ -288,6 +840,8 @@ namespace Plugin {
                     Add(_T("resident"), &Resident);
                     Add(_T("shared"), &Shared);
                     Add(_T("process"), &Process);
+                    Add(_T("descriptors"), &Descriptors);
+                    Add(_T("threads"), &Threads);
                     Add(_T("operational"), &Operational);
                     Add(_T("count"), &Count);
                 }
@@ -301,6 +855,8 @@ namespace Plugin {
                     Resident = RHS.Resident;
                     Shared = RHS.Shared;
                     Process = RHS.Process;
+                    Descriptors = RHS.Descriptors;
+                    Threads = RHS.Threads;
                     Operational = RHS.Operational;
                     Count = RHS.Count;
 
@@ -312,6 +868,8 @@ namespace Plugin {
                 Measurement Resident;
                 Measurement Shared;
                 Measurement Process;
+                Measurement Descriptors;
+                Measurement Threads;
                 Core::JSON::Boolean Operational;
                 Core::JSON::DecUInt32 Count;
             };
@@ -390,22 +948,40 @@ namespace Plugin {
                     Add(_T("callsign"), &Callsign);
                     Add(_T("memory"), &MetaData);
                     Add(_T("memorylimit"), &MetaDataLimit);
+                    Add(_T("adaptive"), &Adaptive);
+                    Add(_T("descriptorlimit"), &DescriptorLimit);
+                    Add(_T("threadlimit"), &ThreadLimit);
                     Add(_T("operational"), &Operational);
                     Add(_T("restart"), &Restart);
+                    Add(_T("escalation"), &Escalation);
+                    Add(_T("priority"), &Priority);
+                    Add(_T("backoff"), &Backoff);
                 }
                 Entry(const Entry& copy)
                     : Core::JSON::Container()
                     , Callsign(copy.Callsign)
                     , MetaData(copy.MetaData)
                     , MetaDataLimit(copy.MetaDataLimit)
+                    , Adaptive(copy.Adaptive)
+                    , DescriptorLimit(copy.DescriptorLimit)
+                    , ThreadLimit(copy.ThreadLimit)
                     , Operational(copy.Operational)
                     , Restart(copy.Restart)
+                    , Escalation(copy.Escalation)
+                    , Priority(copy.Priority)
+                    , Backoff(copy.Backoff)
                 {
                     Add(_T("callsign"), &Callsign);
                     Add(_T("memory"), &MetaData);
                     Add(_T("memorylimit"), &MetaDataLimit);
+                    Add(_T("adaptive"), &Adaptive);
+                    Add(_T("descriptorlimit"), &DescriptorLimit);
+                    Add(_T("threadlimit"), &ThreadLimit);
                     Add(_T("operational"), &Operational);
                     Add(_T("restart"), &Restart);
+                    Add(_T("escalation"), &Escalation);
+                    Add(_T("priority"), &Priority);
+                    Add(_T("backoff"), &Backoff);
                 }
                 ~Entry()
                 {
@@ -415,8 +991,14 @@ namespace Plugin {
                 Core::JSON::String Callsign;
                 Core::JSON::DecUInt32 MetaData;
                 Core::JSON::DecUInt32 MetaDataLimit;
+                AdaptiveInfo Adaptive;
+                Core::JSON::DecUInt32 DescriptorLimit;
+                Core::JSON::DecUInt32 ThreadLimit;
                 Core::JSON::DecSInt32 Operational;
                 RestartInfo Restart;
+                EscalationInfo Escalation;
+                Core::JSON::DecUInt8 Priority;
+                BackoffInfo Backoff;
             };
 
         public:
@@ -424,6 +1006,7 @@ namespace Plugin {
                 : Core::JSON::Container()
             {
                 Add(_T("observables"), &Observables);
+                Add(_T("budget"), &Budget);
             }
             ~Config()
             {
@@ -431,6 +1014,7 @@ namespace Plugin {
 
         public:
             Core::JSON::ArrayType<Entry> Observables;
+            BudgetInfo Budget;
         };
 
         class MonitorObjects : public PluginHost::IPlugin::INotification {
@@ -444,7 +1028,17 @@ namespace Plugin {
                 enum evaluation {
                     SUCCESFULL = 0x00,
                     NOT_OPERATIONAL = 0x01,
-                    EXCEEDED_MEMORY = 0x02
+                    EXCEEDED_MEMORY = 0x02,
+                    RESOLVED_MEMORY = 0x04,
+                    EXCEEDED_RESOURCES = 0x08
+                };
+
+                // Remedies applied, in this order, to an observee exceeding its memory limit.
+                enum class stage : uint8_t {
+                    NONE,
+                    RECLAIM,
+                    SUSPEND,
+                    RESTART
                 };
 
                 typedef struct {
@@ -452,31 +1046,76 @@ namespace Plugin {
                     int32_t WindowSeconds;
                 } RestartSettings;
 
+                typedef struct {
+                    uint16_t Delay; //!< Time (s) to wait before the first restart, doubled for every failure within the window.
+                    uint32_t Window; //!< Time (s) the logged failures are looked back upon.
+                    uint8_t Limit; //!< Number of failures within the window after which restarting stops, 0 if unlimited.
+                } BackoffSettings;
+
+                typedef struct {
+                    uint32_t Descriptors; //!< Maximum number of open file descriptors of all processes, 0 if unlimited.
+                    uint32_t Threads; //!< Maximum number of threads of all processes, 0 if unlimited.
+                } ResourceLimits;
+
+                typedef struct {
+                    uint32_t Min; //!< Shortest interval (us) between memory measurements.
+                    uint32_t Max; //!< Longest interval (us) between memory measurements, 0 if the interval is fixed.
+                } AdaptiveSettings;
+
+                typedef struct {
+                    bool Reclaim;
+                    bool Suspend;
+                    uint32_t Grace; //!< Time (us) to give a remedy before measuring again.
+                } EscalationSettings;
+
             public:
                 MonitorObject(
                     const bool actOnOperational,
                     const uint32_t operationalInterval,
                     const uint32_t memoryInterval,
                     const uint64_t memoryThreshold,
-                    const uint64_t absTime,
+                    const AdaptiveSettings& adaptive,
+                    const ResourceLimits& resourceLimits,
                     const uint16_t restartWindow,
-                    const uint8_t restartLimit)
+                    const uint8_t restartLimit,
+                    const EscalationSettings& escalation,
+                    const uint8_t priority,
+                    const BackoffSettings& backoff)
                     : _operationalInterval(operationalInterval)
                     , _memoryInterval(memoryInterval)
                     , _memoryThreshold(memoryThreshold * 1024)
-                    , _operationalSlots(operationalInterval)
-                    , _memorySlots(memoryInterval)
-                    , _nextSlot(absTime)
+                    , _adaptive(adaptive)
+                    , _resourceLimits(resourceLimits)
+                    , _memoryCurrentInterval(memoryInterval)
+                    , _resident(0)
+                    , _lastResident(0)
+                    , _lastMeasured(0)
+                    , _growth(0)
+                    , _nextOperational(0)
+                    , _nextMemory(0)
+                    , _scheduled(false)
                     , _restartWindow(restartWindow)
                     , _restartWindowStart()
                     , _restartCount(0)
                     , _restartLimit(restartLimit)
+                    , _restarts(0)
+                    , _escalation(escalation)
+                    , _stage(stage::NONE)
+                    , _graceEnd(0)
+                    , _overBudget(false)
+                    , _priority(priority)
+                    , _backoff(backoff)
+                    , _reclaimed(0)
+                    , _suspended(0)
+                    , _escalated(0)
                     , _measurement()
                     , _operational(false)
                     , _operationalEvaluate(actOnOperational)
                     , _source(nullptr)
-                    , _interval( ((operationalInterval != 0) || (_memoryInterval != 0)) ? gcd(_operationalInterval, _memoryInterval) : 0 )
+                    , _extended(nullptr)
                     , _active{ false }
+                    , _index(0)
+                    , _postponed()
                     , _adminLock()
                 {
                     ASSERT((_operationalInterval != 0) || (_memoryInterval != 0));
@@ -487,6 +1126,10 @@ namespace Plugin {
                         _source->Release();
                         _source = nullptr;
                     }
+                    if (_extended != nullptr) {
+                        _extended->Release();
+                        _extended = nullptr;
+                    }
                 }
 
                 MonitorObject(const MonitorObject&) = delete;
@@ -511,6 +1154,8 @@ namespace Plugin {
                     bool result = ((_restartLimit == 0) || (_restartCount < _restartLimit));
                     if (result == false) {
                         _restartCount = 0;
+                    } else {
+                        _restarts++;
                     }
 
                     return result;
@@ -523,6 +1168,117 @@ namespace Plugin {
                 {
                     return _restartWindow;
                 }
+                inline uint32_t Restarts() const
+                {
+                    return _restarts;
+                }
+                inline uint64_t MemoryThreshold() const
+                {
+                    return _memoryThreshold;
+                }
+                inline stage Stage() const
+                {
+                    return (_stage);
+                }
+                // The remedy to apply after the given one did not bring the memory usage down.
+                inline stage Escalate(const stage current) const
+                {
+                    stage result(stage::RESTART);
+
+                    if ((current == stage::NONE) && (_escalation.Reclaim == true)) {
+                        result = stage::RECLAIM;
+                    } else if (((current == stage::NONE) || (current == stage::RECLAIM)) && (_escalation.Suspend == true)) {
+                        result = stage::SUSPEND;
+                    }
+
+                    return (result);
+                }
+                // The remedy of the given stage is applied, measure again once the grace period passed.
+                inline void Escalated(const stage applied, const uint64_t now)
+                {
+                    _stage = applied;
+
+                    if (applied == stage::RESTART) {
+                        _escalated++;
+                    } else {
+                        _nextMemory = now + _escalation.Grace;
+                        _graceEnd = _nextMemory;
+                    }
+                }
+                // The remedies job could not apply the planned remedy, but a later one.
+                inline void Remedied(const stage applied)
+                {
+                    _stage = applied;
+
+                    if (applied == stage::RESTART) {
+                        _escalated++;
+                    }
+                }
+                // A remedy is applied, but its effect has not been measured yet.
+                inline bool InGrace(const uint64_t now) const
+                {
+                    const stage current(_stage);
+
+                    return (((current == stage::RECLAIM) || (current == stage::SUSPEND)) && (now < _graceEnd));
+                }
+                // Remedies are applied because the system wide budget, rather than the own limit, is exceeded.
+                // Such an incident is resolved by the budget arbiter once the budget is met again.
+                inline void OverBudget()
+                {
+                    _overBudget = true;
+                }
+                inline bool IsOverBudget() const
+                {
+                    return (_overBudget);
+                }
+                inline uint8_t Priority() const
+                {
+                    return (_priority);
+                }
+                inline const BackoffSettings& Backoff() const
+                {
+                    return (_backoff);
+                }
+                // Last measured resident memory, 0 if not measured since the observee was activated.
+                inline uint64_t Resident() const
+                {
+                    return (_resident);
+                }
+                // The observee went away, whatever was going on is no longer of interest.
+                inline void Abandon()
+                {
+                    _stage = stage::NONE;
+                    _overBudget = false;
+                }
+                // The incident is over, returns the stage that resolved it.
+                inline stage Resolved()
+                {
+                    stage result(_stage.exchange(stage::NONE));
+
+                    _overBudget = false;
+
+                    if (result == stage::RECLAIM) {
+                        _reclaimed++;
+                    } else if (result == stage::SUSPEND) {
+                        _suspended++;
+                    }
+
+                    return (result);
+                }
+                inline uint32_t Incidents(const stage resolvedBy) const
+                {
+                    uint32_t result = 0;
+
+                    if (resolvedBy == stage::RECLAIM) {
+                        result = _reclaimed;
+                    } else if (resolvedBy == stage::SUSPEND) {
+                        result = _suspended;
+                    } else if (resolvedBy == stage::RESTART) {
+                        result = _escalated;
+                    }
+
+                    return (result);
+                }
                 inline void UpdateRestartLimits(
                     const uint16_t restartWindow,
                     const uint8_t restartLimit)
@@ -534,10 +1290,6 @@ namespace Plugin {
                 {
                     return (_operationalEvaluate);
                 }
-                inline uint32_t Interval() const
-                {
-                    return (_interval);
-                }
                 inline uint32_t Operational() const
                 {
                     return (_operational);
@@ -547,32 +1299,85 @@ namespace Plugin {
                     Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
                     return (_measurement);
                 }
-                inline uint64_t TimeSlot() const
+                // Look at the measurement in place, without copying it (and its histograms).
+                template <typename ACTION>
+                void Visit(ACTION&& action) const
                 {
-                    return (_nextSlot);
+                    Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+                    action(_measurement);
                 }
-                inline void Reset()
+                inline uint32_t Index() const
                 {
-                    Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
-                    _measurement.Reset();
+                    return (_index);
                 }
-                inline void Retrigger(uint64_t currentSlot)
+                inline void Index(const uint32_t index)
+                {
+                    _index = index;
+                }
+                inline uint64_t TimeSlot() const
                 {
-                    while (_nextSlot < currentSlot) {
-                        _nextSlot += _interval;
+                    uint64_t result(static_cast<uint64_t>(~0));
+
+                    if (_operationalInterval != 0) {
+                        result = _nextOperational;
+                    }
+                    if ((_memoryInterval != 0) && (_nextMemory < result)) {
+                        result = _nextMemory;
                     }
+
+                    return (result);
+                }
+                inline void Schedule(const uint64_t now)
+                {
+                    _memoryCurrentInterval = _memoryInterval;
+                    _lastMeasured = 0;
+                    _growth = 0;
+                    _nextOperational = now + _operationalInterval;
+                    _nextMemory = now + _memoryCurrentInterval;
+                    _resident = 0;
+                    _stage = stage::NONE;
+                    _overBudget = false;
+                }
+                inline uint32_t MemoryInterval() const
+                {
+                    return (_memoryCurrentInterval);
+                }
+                inline bool IsScheduled() const
+                {
+                    return (_scheduled);
+                }
+                inline void Scheduled(const bool scheduled)
+                {
+                    _scheduled = scheduled;
+                }
+                inline void Reset()
+                {
+                    Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+                    _measurement.Reset();
                 }
                 inline void Set(Exchange::IMemory* memory)
                 {
+                    // The extended interface tells us what processes make up the plugin, to count their descriptors and threads.
+                    Exchange::IMemoryExtended* extended = nullptr;
+
+                    if (memory != nullptr) {
+                        extended = memory->QueryInterface<Exchange::IMemoryExtended>();
+                    }
+
                     _adminLock.Lock();
                     if (_source != nullptr) {
                         _source->Release();
                         _source = nullptr;
                     }
+                    if (_extended != nullptr) {
+                        _extended->Release();
+                        _extended = nullptr;
+                    }
 
                     if (memory != nullptr) {
                         _source = memory;
                         _source->AddRef();
+                        _extended = extended;
                     }
                     _adminLock.Unlock();
 
@@ -590,25 +1395,24 @@ namespace Plugin {
                     return source;
                 }
 
-                inline uint32_t Evaluate()
+                inline uint32_t Evaluate(const uint64_t now)
                 {
                     Core::ProxyType<const Exchange::IMemory> source = Source();
 
                     uint32_t status(SUCCESFULL);
-                    if (source.IsValid() == true) {
-                        _operationalSlots -= _interval;
-                        _memorySlots -= _interval;
 
-                        if ((_operationalInterval != 0) && (_operationalSlots == 0)) {
+                    if ((_operationalInterval != 0) && (_nextOperational <= now)) {
+                        if (source.IsValid() == true) {
                             _operational = source->IsOperational();
                             if (_operational == false) {
                                 status |= NOT_OPERATIONAL;
                                 TRACE(Trace::Error, (_T("Status not operational. %d"), __LINE__));
                             }
-                            _operationalSlots = _operationalInterval;
                         }
-                        if ((_memoryInterval != 0) && (_memorySlots == 0)) {
-
+                        _nextOperational = Advance(_nextOperational, _operationalInterval, now);
+                    }
+                    if ((_memoryInterval != 0) && (_nextMemory <= now)) {
+                        if (source.IsValid() == true) {
                             uint64_t resident = source->Resident();
                             uint64_t allocated = source->Allocated();
                             uint64_t shared = source->Shared();
@@ -618,36 +1422,234 @@ namespace Plugin {
                             _measurement.AddMeasurements(resident, allocated, shared, process);
                             _adminLock.Unlock();
 
+                            _resident = resident;
+
                             if ((_memoryThreshold != 0) && (resident > _memoryThreshold)) {
                                 status |= EXCEEDED_MEMORY;
                                 TRACE(Trace::Error, (_T("Status MetaData Exceeded. %d"), __LINE__));
+                            } else if (((_stage == stage::RECLAIM) || (_stage == stage::SUSPEND)) && (_overBudget == false)) {
+                                status |= RESOLVED_MEMORY;
+                            }
+
+                            _memoryCurrentInterval = Adapt(resident, now);
+
+                            uint32_t descriptors = 0;
+                            uint32_t threads = 0;
+
+                            if (Resources(descriptors, threads) == true) {
+                                _adminLock.Lock();
+                                _measurement.AddResources(descriptors, threads);
+                                _adminLock.Unlock();
+
+                                if (((_resourceLimits.Descriptors != 0) && (descriptors > _resourceLimits.Descriptors)) || ((_resourceLimits.Threads != 0) && (threads > _resourceLimits.Threads))) {
+                                    status |= EXCEEDED_RESOURCES;
+                                    TRACE(Trace::Error, (_T("Status Resources Exceeded (descriptors: %u, threads: %u). %d"), descriptors, threads, __LINE__));
+                                }
                             }
-                            _memorySlots = _memoryInterval;
                         }
+                        _nextMemory = Advance(_nextMemory, _memoryCurrentInterval, now);
                     }
+
                     return (status);
                 }
 
                 bool IsActive() const { return _active; }
                 void Active(bool active) { _active = active; }
 
+                // The restart that is scheduled after a backoff delay, so it can be called off.
+                inline void Postpone(const Core::ProxyType<Core::IDispatch>& job)
+                {
+                    Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+                    _postponed = job;
+                }
+                inline Core::ProxyType<Core::IDispatch> Postponed()
+                {
+                    Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+                    Core::ProxyType<Core::IDispatch> result(_postponed);
+                    _postponed.Release();
+                    return (result);
+                }
+
+                inline uint32_t DescriptorLimit() const
+                {
+                    return (_resourceLimits.Descriptors);
+                }
+                inline uint32_t ThreadLimit() const
+                {
+                    return (_resourceLimits.Threads);
+                }
+
+            private:
+                // Sum of the open file descriptors and threads of all processes of the observee.
+                bool Resources(uint32_t& descriptors, uint32_t& threads) const
+                {
+                    bool result = false;
+
+                    _adminLock.Lock();
+                    Exchange::IMemoryExtended* extended = _extended;
+                    if (extended != nullptr) {
+                        extended->AddRef();
+                    }
+                    _adminLock.Unlock();
+
+                    if (extended != nullptr) {
+                        Exchange::IMemoryExtended::IStringIterator* iterator = nullptr;
+
+                        if ((extended->Processes(iterator) == Core::ERROR_NONE) && (iterator != nullptr)) {
+                            string name;
+
+                            while (iterator->Next(name) == true) {
+                                Exchange::IProcessMemory* process = nullptr;
+
+                                if ((extended->Process(name, process) == Core::ERROR_NONE) && (process != nullptr)) {
+                                    const uint32_t pid = process->Identifier();
+
+                                    if (pid != 0) {
+                                        descriptors += Descriptors(pid);
+                                        threads += Threads(pid);
+                                        result = true;
+                                    }
+
+                                    process->Release();
+                                }
+                            }
+
+                            iterator->Release();
+                        }
+
+                        extended->Release();
+                    }
+
+                    return (result);
+                }
+                static uint32_t Descriptors(const uint32_t pid)
+                {
+                    uint32_t result = 0;
+#ifndef __WINDOWS__
+                    char path[32];
+                    snprintf(path, sizeof(path), "/proc/%u/fd", pid);
+
+                    DIR* directory = opendir(path);
+
+                    if (directory != nullptr) {
+                        const struct dirent* entry;
+
+                        while ((entry = readdir(directory)) != nullptr) {
+                            if (entry->d_name[0] != '.') {
+                                result++;
+                            }
+                        }
+
+                        closedir(directory);
+                    }
+#else
+                    DEBUG_VARIABLE(pid);
+#endif
+                    return (result);
+                }
+                static uint32_t Threads(const uint32_t pid)
+                {
+                    uint32_t result = 0;
+#ifndef __WINDOWS__
+                    char path[32];
+                    snprintf(path, sizeof(path), "/proc/%u/status", pid);
+
+                    FILE* file = fopen(path, "r");
+
+                    if (file != nullptr) {
+                        char line[128];
+
+                        while (fgets(line, sizeof(line), file) != nullptr) {
+                            if (strncmp(line, "Threads:", 8) == 0) {
+                                result = static_cast<uint32_t>(strtoul(&line[8], nullptr, 10));
+                                break;
+                            }
+                        }
+
+                        fclose(file);
+                    }
+#else
+                    DEBUG_VARIABLE(pid);
+#endif
+                    return (result);
+                }
+                // The closer the observee gets to its limit, or the faster it is heading there, the more often we look.
+                uint32_t Adapt(const uint64_t resident, const uint64_t now)
+                {
+                    uint32_t result = _memoryCurrentInterval;
+
+                    if ((_adaptive.Max != 0) && (_memoryThreshold != 0)) {
+                        if ((_lastMeasured != 0) && (now > _lastMeasured)) {
+                            // Shrinking is just no growth, smooth out the spikes with an exponential moving average.
+                            const uint64_t growth = (resident > _lastResident ? (((resident - _lastResident) * Core::Time::MicroSecondsPerSecond) / (now - _lastMeasured)) : 0);
+                            _growth = (_growth + growth) / 2;
+                        }
+
+                        _lastResident = resident;
+                        _lastMeasured = now;
+
+                        if (resident >= _memoryThreshold) {
+                            result = _adaptive.Min;
+                        } else {
+                            const uint64_t headroom = _memoryThreshold - resident;
+                            const double free = static_cast<double>(headroom) / static_cast<double>(_memoryThreshold);
+
+                            double interval = _adaptive.Min + ((_adaptive.Max - _adaptive.Min) * free * free);
+
+                            if (_growth != 0) {
+                                // Get at least a few more looks before the limit is reached at the current pace.
+                                const double reach = (static_cast<double>(headroom) * Core::Time::MicroSecondsPerSecond) / static_cast<double>(_growth) / 4;
+                                interval = std::min(interval, reach);
+                            }
+
+                            result = static_cast<uint32_t>(std::max(interval, static_cast<double>(_adaptive.Min)));
+                        }
+                    }
+
+                    return (result);
+                }
+                static uint64_t Advance(const uint64_t slot, const uint32_t interval, const uint64_t now)
+                {
+                    // If we overslept, do not try to catch up on the missed slots, just continue from now.
+                    return ((slot + interval) > now ? (slot + interval) : (now + interval));
+                }
+
             private:
-                const uint32_t _operationalInterval; //!< Interval (s) to check the monitored processes
-                const uint32_t _memoryInterval; //!<  Interval (s) for a memory measurement.
+                const uint32_t _operationalInterval; //!< Interval (us) to check the monitored processes
+                const uint32_t _memoryInterval; //!<  Interval (us) for a memory measurement.
                 const uint64_t _memoryThreshold; //!< MetaData threshold in bytes for all processes.
-                uint32_t _operationalSlots; // does not need protection, only touched in job evaluate
-                uint32_t _memorySlots; // does not need protection, only touched in job evaluate
-                std::atomic<uint64_t> _nextSlot; // no ordering needed, atomic should suffice
+                const AdaptiveSettings _adaptive;
+                const ResourceLimits _resourceLimits;
+                std::atomic<uint32_t> _memoryCurrentInterval; // only changed in job evaluate or while (re)scheduling, atomic for reporting
+                uint64_t _resident; // only touched in job evaluate or while (re)scheduling under the schedule lock
+                uint64_t _lastResident; // only touched in job evaluate or while (re)scheduling under the schedule lock
+                uint64_t _lastMeasured; // only touched in job evaluate or while (re)scheduling under the schedule lock
+                uint64_t _growth; //!< Smoothed growth of the resident memory in bytes per second.
+                uint64_t _nextOperational; // only touched in job evaluate or while (re)scheduling under the schedule lock
+                uint64_t _nextMemory; // only touched in job evaluate or while (re)scheduling under the schedule lock
+                bool _scheduled; // protected by the schedule lock of MonitorObjects
                 std::atomic<uint16_t> _restartWindow; // no ordering needed, atomic should suffice
                 Core::Time _restartWindowStart; // only used in job (indirectly), no protection needed
                 uint32_t _restartCount; // only used in job (indirectly), no protection needed
                 std::atomic<uint8_t> _restartLimit; // no ordering needed, atomic should suffice
+                std::atomic<uint32_t> _restarts; // total number of automatic restarts, no ordering needed
+                const EscalationSettings _escalation;
+                std::atomic<stage> _stage; // no ordering needed, atomic should suffice
+                uint64_t _graceEnd; // only touched in the job
+                std::atomic<bool> _overBudget; // no ordering needed, atomic should suffice
+                const uint8_t _priority; //!< Observees with a lower priority are the first to give up memory for the budget.
+                const BackoffSettings _backoff;
+                std::atomic<uint32_t> _reclaimed; // incidents resolved by reclaiming memory
+                std::atomic<uint32_t> _suspended; // incidents resolved by suspending
+                std::atomic<uint32_t> _escalated; // incidents that required a restart
                 MetaData _measurement;
                 std::atomic<bool> _operational; // no ordering needed, atomic should suffice
                 const bool _operationalEvaluate;
                 Exchange::IMemory* _source;
-                const uint32_t _interval; //!< The greatest possible interval to check both memory and processes.
+                Exchange::IMemoryExtended* _extended;
                 std::atomic<bool> _active;
+                uint32_t _index; // only set in Open, position of the rendered sample
+                Core::ProxyType<Core::IDispatch> _postponed; // protected by the admin lock
                 mutable Core::CriticalSection _adminLock;
             };
 
@@ -658,6 +1660,18 @@ namespace Plugin {
 PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
             MonitorObjects(Monitor* parent)
                 : _monitor()
+                , _schedule()
+                , _due()
+                , _scheduleLock()
+                , _samples()
+                , _scratch()
+                , _metrics()
+                , _renderLock()
+                , _metricsLock()
+                , _budget()
+                , _log()
+                , _candidates()
+                , _remedies(*this)
                 , _job(*this)
                 , _service(nullptr)
                 , _parent(*parent)
@@ -686,29 +1700,50 @@ POP_WARNING()
                         restartLimit);
                 }
             }
-            inline void Open(PluginHost::IShell* service, Core::JSON::ArrayType<Config::Entry>::Iterator& index)
+            inline void Open(PluginHost::IShell* service, const BudgetInfo& budget, Core::JSON::ArrayType<Config::Entry>::Iterator& index)
             {
                 ASSERT((service != nullptr) && (_service == nullptr));
 
-                uint64_t baseTime = Core::Time::Now().Ticks();
-
                 _service = service;
                 _service->AddRef();
 
+                Core::Directory(_service->PersistentPath().c_str()).CreatePath();
+                _log.Open(_service->PersistentPath() + _T("restarts.log"));
+
+                const uint64_t limit(static_cast<uint64_t>(budget.Limit.Value()) * 1024);
+                const uint64_t reserve(static_cast<uint64_t>(budget.Reserve.Value()) * 1024);
+
+                // Without a headroom a plugin suspended for the budget would be resumed, and suspended again, over and over.
+                _budget = BudgetType(limit, reserve, (budget.Headroom.IsSet() == true ? static_cast<uint64_t>(budget.Headroom.Value()) * 1024 : std::max(limit, reserve) / 10));
+
                 while (index.Next() == true) {
                     Config::Entry& element(index.Current());
                     string callSign(element.Callsign.Value());
                     uint64_t memoryThreshold(element.MetaDataLimit.Value());
-                    uint32_t interval = abs(element.Operational.Value());
-                    interval = interval * 1000 * 1000; // Move from Seconds to MicroSecond
-                    uint32_t memory(element.MetaData.Value() * 1000 * 1000); // Move from Seconds to MicroSeconds
+                    uint32_t interval(MicroSeconds(static_cast<uint32_t>(abs(element.Operational.Value()))));
+                    uint32_t memory(MicroSeconds(element.MetaData.Value()));
                     uint16_t restartWindow = 0;
                     uint8_t restartLimit = 0;
+                    MonitorObject::AdaptiveSettings adaptive{ memory, 0 };
+                    MonitorObject::ResourceLimits resourceLimits{ element.DescriptorLimit.Value(), element.ThreadLimit.Value() };
+                    MonitorObject::EscalationSettings escalation{ false, false, memory };
+                    MonitorObject::BackoffSettings backoff{ element.Backoff.Delay.Value(), element.Backoff.Window.Value(), element.Backoff.Limit.Value() };
 
                     if (element.Restart.IsSet()) {
                         restartWindow = element.Restart.Window;
                         restartLimit = element.Restart.Limit;
                     }
+                    if ((element.Adaptive.IsSet()) && (memory != 0) && (memoryThreshold != 0)) {
+                        adaptive.Min = std::min(MicroSeconds(std::max(element.Adaptive.Min.Value(), 1u)), memory);
+                        adaptive.Max = std::max(MicroSeconds(element.Adaptive.Max.Value()), memory);
+                    }
+                    if (element.Escalation.IsSet()) {
+                        escalation.Reclaim = element.Escalation.Reclaim.Value();
+                        escalation.Suspend = element.Escalation.Suspend.Value();
+                        if (element.Escalation.Grace.Value() != 0) {
+                            escalation.Grace = MicroSeconds(element.Escalation.Grace.Value());
+                        }
+                    }
                     SYSLOG(Logging::Startup, (_T("Monitoring: %s (%d,%d)."), callSign.c_str(), (interval / 1000000), (memory / 1000000)));
                     if ((interval != 0) || (memory != 0)) {
 
@@ -719,22 +1754,67 @@ POP_WARNING()
                                             interval,
                                             memory,
                                             memoryThreshold,
-                                            baseTime,
+                                            adaptive,
+                                            resourceLimits,
                                             restartWindow,
-                                            restartLimit)
+                                            restartLimit,
+                                            escalation,
+                                            element.Priority.Value(),
+                                            backoff)
                                     );
                     }
                 }
 
-                _job.Submit();
+                // Reserve all we could ever need up front, so (re)scheduling never allocates.
+                _schedule.Reserve(_monitor.size());
+                _due.reserve(_monitor.size());
+                _candidates.reserve(_monitor.size());
+                _remedies.Reserve(static_cast<uint32_t>(_monitor.size()));
+
+                // The observees are fixed from here on, so is what is rendered of them.
+                _samples.reserve(_monitor.size());
+                for (std::pair<const string, MonitorObject>& element : _monitor) {
+                    if (element.first == _T("metrics")) {
+                        SYSLOG(Logging::Startup, (_T("Observee [metrics] takes precedence over the /metrics endpoint.")));
+                    }
+                    element.second.Index(static_cast<uint32_t>(_samples.size()));
+                    _samples.push_back({ &element.first, &element.second, false, 0, {}, {}, {}, {}, {}, {} });
+                }
+
+                if (IsBudgeted() == true) {
+                    SYSLOG(Logging::Startup, (_T("Memory budget: limit %llu KB, reserve %llu KB, headroom %llu KB."), static_cast<unsigned long long>(_budget.Limit() / 1024), static_cast<unsigned long long>(_budget.Reserve() / 1024), static_cast<unsigned long long>(_budget.Headroom() / 1024)));
+                }
+
+                _renderLock.Lock();
+                Compose();
+                _renderLock.Unlock();
             }
             inline void Close()
             {
                 ASSERT(_service != nullptr);
 
                 _job.Revoke();
+                _remedies.Clear();
+
+                for (std::pair<const string, MonitorObject>& element : _monitor) {
+                    Revoke(element.second);
+                }
+
+                _scheduleLock.Lock();
+                _schedule.Clear();
+                _scheduleLock.Unlock();
+                _due.clear();
+                _candidates.clear();
+
+                _renderLock.Lock();
+                _samples.clear();
+                _metricsLock.Lock();
+                _metrics.clear();
+                _metricsLock.Unlock();
+                _renderLock.Unlock();
 
                 _monitor.clear();
+                _log.Close();
                 _service->Release();
                 _service = nullptr;
             }
@@ -744,6 +1824,9 @@ POP_WARNING()
 
                 if (index != _monitor.end()) {
 
+                    // Activated before the backoff delay passed, the pending restart is no longer needed.
+                    Revoke(index->second);
+
                     index->second.Active(true);
 
                     // Get the MetaData interface
@@ -754,9 +1837,11 @@ POP_WARNING()
                         memory->Release();
                     }
 
-                    if (_job.Submit() == true) {
+                    if (Schedule(*index) == true) {
                         TRACE(Trace::Information, (_T("Starting to probe as active observee appeared.")));
                     }
+
+                    Render(index->second);
                 }
             }
             void Deactivated (const string& callsign, PluginHost::IShell* service) override
@@ -765,27 +1850,70 @@ POP_WARNING()
 
                 if (index != _monitor.end()) {
 
+                    // Evicted to meet the system wide budget, bringing it back would just exceed it again. A plugin that
+                    // was only suspended for the budget, but crashed on its own, is restarted as usual.
+                    const bool evicted = ((index->second.Stage() == MonitorObject::stage::RESTART) && (index->second.IsOverBudget() == true));
+
                     index->second.Set(nullptr);
                     index->second.Active(false);
+                    index->second.Abandon();
 
                     PluginHost::IShell::reason reason = service->Reason();
 
-                    if ((index->second.HasRestartAllowed() == true) && ((reason == PluginHost::IShell::MEMORY_EXCEEDED) || (reason == PluginHost::IShell::FAILURE))) {
-                        if (index->second.RegisterRestart(reason) == false) {
-                            uint8_t restartlimit = index->second.RestartLimit();
-                            uint16_t restartwindow = index->second.RestartWindow();
-                            TRACE(Trace::Fatal, (_T("Giving up restarting of %s: Failed more than %d times within %d seconds."), callsign.c_str(), restartlimit, restartwindow));
-                            const string message("{\"callsign\": \"" + callsign + "\", \"action\": \"Restart\", \"reason\":\"" + (std::to_string(restartlimit)).c_str() + " Attempts Failed within the restart window\"}");
-                            _service->Notify(message);
-                            _parent.event_action(callsign, "StoppedRestaring", std::to_string(index->second.RestartLimit()) + " attempts failed within the restart window");
-                        } else {
-                            const string message("{\"callsign\": \"" + callsign + "\", \"action\": \"Activate\", \"reason\": \"Automatic\" }");
-                            _service->Notify(message);
-                            _parent.event_action(callsign, "Activate", "Automatic");
-                            TRACE(Trace::Error, (_T("Restarting %s again because we detected it misbehaved."), callsign.c_str()));
-                            Core::IWorkerPool::Instance().Submit(PluginHost::IShell::Job::Create(service, PluginHost::IShell::ACTIVATED, PluginHost::IShell::AUTOMATIC));
+                    if ((reason == PluginHost::IShell::MEMORY_EXCEEDED) || (reason == PluginHost::IShell::FAILURE)) {
+                        const MonitorObject::BackoffSettings& backoff(index->second.Backoff());
+                        const uint64_t now(Core::Time::Now().Ticks() / Core::Time::MicroSecondsPerSecond);
+
+                        // Earlier failures, also those from before the framework (or the box) restarted.
+                        const uint32_t failures(_log.Failures(callsign, (backoff.Window != 0) && (now > backoff.Window) ? (now - backoff.Window) : 0));
+                        const TCHAR* action(_T("None"));
+
+                        if (evicted == true) {
+                            action = _T("Evicted");
+                        } else if (index->second.HasRestartAllowed() == true) {
+                            // Decide on giving up before registering the restart, a restart that is not done is not counted.
+                            if ((backoff.Limit != 0) && (failures >= backoff.Limit)) {
+                                TRACE(Trace::Fatal, (_T("Giving up restarting of %s: Crash loop, failed %u times before."), callsign.c_str(), failures));
+                                const string message("{\"callsign\": \"" + callsign + "\", \"action\": \"Restart\", \"reason\":\"" + std::to_string(failures) + " Failures within the backoff window\"}");
+                                _service->Notify(message);
+                                _parent.event_action(callsign, "StoppedRestaring", std::to_string(failures) + " failures within the backoff window");
+                                action = _T("GiveUp");
+                            } else if (index->second.RegisterRestart(reason) == false) {
+                                uint8_t restartlimit = index->second.RestartLimit();
+                                uint16_t restartwindow = index->second.RestartWindow();
+                                TRACE(Trace::Fatal, (_T("Giving up restarting of %s: Failed more than %d times within %d seconds."), callsign.c_str(), restartlimit, restartwindow));
+                                const string message("{\"callsign\": \"" + callsign + "\", \"action\": \"Restart\", \"reason\":\"" + (std::to_string(restartlimit)).c_str() + " Attempts Failed within the restart window\"}");
+                                _service->Notify(message);
+                                _parent.event_action(callsign, "StoppedRestaring", std::to_string(index->second.RestartLimit()) + " attempts failed within the restart window");
+                                action = _T("GiveUp");
+                            } else {
+                                // Every failure within the window doubles the time we wait before trying again, up to a day.
+                                const uint32_t delay(static_cast<uint32_t>(std::min(static_cast<uint64_t>(backoff.Delay) << std::min(failures, 10u), static_cast<uint64_t>(MaxBackoffDelay))));
+
+                                const string message("{\"callsign\": \"" + callsign + "\", \"action\": \"Activate\", \"reason\": \"Automatic\" }");
+                                _service->Notify(message);
+                                _parent.event_action(callsign, "Activate", "Automatic");
+                                TRACE(Trace::Error, (_T("Restarting %s again in %u seconds because we detected it misbehaved."), callsign.c_str(), delay));
+
+                                if (delay == 0) {
+                                    Core::IWorkerPool::Instance().Submit(PluginHost::IShell::Job::Create(service, PluginHost::IShell::ACTIVATED, PluginHost::IShell::AUTOMATIC));
+                                } else {
+                                    Core::ProxyType<Core::IDispatch> job(PluginHost::IShell::Job::Create(service, PluginHost::IShell::ACTIVATED, PluginHost::IShell::AUTOMATIC));
+
+                                    index->second.Postpone(job);
+                                    Core::IWorkerPool::Instance().Schedule(Core::Time::Now().Add(delay * 1000), job);
+                                }
+                                action = _T("Restart");
+                            }
                         }
+
+                        index->second.Visit([&](const MetaData& measurement) {
+                            _log.Add({ now, callsign, Core::EnumerateType<PluginHost::IShell::reason>(reason).Data(), action,
+                                       measurement.Resident().Last(), measurement.Allocated().Last(), measurement.Shared().Last(), measurement.Process().Last() });
+                        });
                     }
+
+                    Render(index->second);
                 }
             }
             void Unavailable(const string&, PluginHost::IShell*) override
@@ -805,6 +1933,10 @@ POP_WARNING()
                 }
 
             }
+            bool IsObserved(const string& name) const
+            {
+                return (_monitor.find(name) != _monitor.end());
+            }
             bool Snapshot(const string& name, Monitor::MetaData& result, bool& operational) const
             {
                 bool found = false;
@@ -874,6 +2006,8 @@ POP_WARNING()
                     operational = index->second.Operational();
                     index->second.Reset();
                     found = true;
+
+                    Render(index->second);
                 }
 
                 return (found);
@@ -888,11 +2022,28 @@ POP_WARNING()
                 if (index != _monitor.end()) {
                     index->second.Reset();
                     found = true;
+
+                    Render(index->second);
                 }
 
                 return (found);
             }
 
+            void RestartHistory(const string& callsign, Core::JSON::ArrayType<Monitor::History>& response) const
+            {
+                _log.Visit(callsign, [&response](const RestartLog::Entry& entry) {
+                    response.Add(Monitor::History(entry));
+                });
+            }
+
+            // Prometheus text exposition of all observees, rendered whenever a sample is taken.
+            void Metrics(string& result) const
+            {
+                _metricsLock.Lock();
+                result = _metrics;
+                _metricsLock.Unlock();
+            }
+
             BEGIN_INTERFACE_MAP(MonitorObjects)
             INTERFACE_ENTRY(PluginHost::IPlugin::INotification)
             END_INTERFACE_MAP
@@ -900,51 +2051,439 @@ POP_WARNING()
         private:
             friend Core::ThreadPool::JobType<MonitorObjects&>;
 
-            void Dispatch()
+            // Remedies call into the plugin, which might be out of process and slow to answer. They are applied on a
+            // job of their own, so they never hold up the measurements of the other observees.
+            struct Remedy {
+                std::pair<const string, MonitorObject>* Element;
+                MonitorObject::stage Stage; // first remedy to try, NONE to resume the observee
+                const TCHAR* Reason;
+            };
+            class Remedies {
+            public:
+                Remedies() = delete;
+                Remedies(const Remedies&) = delete;
+                Remedies& operator=(const Remedies&) = delete;
+
+                Remedies(MonitorObjects& parent)
+                    : _parent(parent)
+                    , _adminLock()
+                    , _queue()
+                    , _pending()
+                    , _job(*this)
+                {
+                }
+                ~Remedies() = default;
+
+            public:
+                void Reserve(const uint32_t size)
+                {
+                    // An observee has at most a remedy and a resume outstanding.
+                    _queue.reserve(2 * size);
+                    _pending.reserve(2 * size);
+                }
+                void Push(const Remedy& remedy)
+                {
+                    _adminLock.Lock();
+                    _queue.push_back(remedy);
+                    _adminLock.Unlock();
+
+                    _job.Submit();
+                }
+                void Clear()
+                {
+                    _job.Revoke();
+
+                    _adminLock.Lock();
+                    _queue.clear();
+                    _adminLock.Unlock();
+                    _pending.clear();
+                }
+
+            private:
+                friend Core::ThreadPool::JobType<Remedies&>;
+
+                void Dispatch()
+                {
+                    _adminLock.Lock();
+                    _pending.swap(_queue);
+                    _adminLock.Unlock();
+
+                    for (const Remedy& remedy : _pending) {
+                        _parent.Apply(remedy);
+                    }
+
+                    _pending.clear();
+                }
+
+            private:
+                MonitorObjects& _parent;
+                Core::CriticalSection _adminLock;
+                std::vector<Remedy> _queue;
+                std::vector<Remedy> _pending; // only used in the job
+                Core::WorkerPool::JobType<Remedies&> _job;
+            };
+
+            bool Schedule(std::pair<const string, MonitorObject>& element)
             {
-                uint64_t scheduledTime(Core::Time::Now().Ticks());
-                uint64_t nextSlot(static_cast<uint64_t>(~0));
+                bool earliest = false;
+
+                _scheduleLock.Lock();
+
+                if (element.second.IsScheduled() == false) {
+                    element.second.Schedule(Core::Time::Now().Ticks());
+                    element.second.Scheduled(true);
+
+                    earliest = _schedule.Push(element.second.TimeSlot(), &element);
+                }
+
+                _scheduleLock.Unlock();
+
+                if (earliest == true) {
+                    _job.Reschedule(Core::Time(element.second.TimeSlot()));
+                }
+
+                return (earliest);
+            }
+
+            static constexpr uint32_t MaxBackoffDelay = 24 * 60 * 60; // seconds
+
+            // Intervals are configured in seconds, but kept in microseconds. Whatever does not fit is clamped.
+            static uint32_t MicroSeconds(const uint32_t seconds)
+            {
+                return (static_cast<uint32_t>(std::min(static_cast<uint64_t>(seconds) * Core::Time::MicroSecondsPerSecond, static_cast<uint64_t>(std::numeric_limits<uint32_t>::max()))));
+            }
+
+            // Call off a restart that is still waiting for its backoff delay. Not waiting for it, as it might be
+            // the one that activates the plugin right now.
+            static void Revoke(MonitorObject& info)
+            {
+                Core::ProxyType<Core::IDispatch> job(info.Postponed());
+
+                if (job.IsValid() == true) {
+                    Core::IWorkerPool::Instance().Revoke(job, 0);
+                }
+            }
+
+            static const TCHAR* StageName(const MonitorObject::stage value)
+            {
+                return (value == MonitorObject::stage::RECLAIM ? _T("Reclaim") :
+                        value == MonitorObject::stage::SUSPEND ? _T("Suspend") :
+                        value == MonitorObject::stage::RESTART ? _T("Restart") : _T("None"));
+            }
+
+            // Pick the next remedy that is configured and let the remedies job apply it. Returns false if nothing
+            // is left but to restart it.
+            bool Escalate(std::pair<const string, MonitorObject>& element, const uint64_t now, const TCHAR reason[])
+            {
+                MonitorObject& info(element.second);
+                const MonitorObject::stage stage(info.Escalate(info.Stage()));
+
+                info.Escalated(stage, now);
+
+                if (stage != MonitorObject::stage::RESTART) {
+                    _remedies.Push({ &element, stage, reason });
+                }
+
+                return (stage != MonitorObject::stage::RESTART);
+            }
+
+            // The incident is over, a plugin suspended to resolve it may continue.
+            void Resolve(std::pair<const string, MonitorObject>& element, const TCHAR reason[])
+            {
+                const MonitorObject::stage resolvedBy(element.second.Resolved());
+                const TCHAR* stage = StageName(resolvedBy);
+
+                const string message("{\"callsign\": \"" + element.first + "\", \"action\": \"Resolved\", \"reason\": \"" + stage + "\" }");
+                SYSLOG(Logging::Notification, (_T("%s, %s after: %s."), reason, element.first.c_str(), stage));
+
+                _service->Notify(message);
+
+                _parent.event_action(element.first, "Resolved", stage);
+
+                if (resolvedBy == MonitorObject::stage::SUSPEND) {
+                    _remedies.Push({ &element, MonitorObject::stage::NONE, reason });
+                }
+            }
+
+            // Runs on the remedies job. Tries the given remedy and falls back to the next one configured, if the
+            // plugin does not support it. If none of them apply, the plugin is restarted.
+            void Apply(const Remedy& remedy)
+            {
+                MonitorObject& info(remedy.Element->second);
+                PluginHost::IShell* plugin = (info.IsActive() == true ? _service->QueryInterfaceByCallsign<PluginHost::IShell>(remedy.Element->first) : nullptr);
+
+                if (plugin != nullptr) {
+                    if (remedy.Stage == MonitorObject::stage::NONE) {
+                        PluginHost::IStateControl* control = plugin->QueryInterface<PluginHost::IStateControl>();
+
+                        if (control != nullptr) {
+                            if (control->State() == PluginHost::IStateControl::SUSPENDED) {
+                                SYSLOG(Logging::Notification, (_T("Resuming %s, it was suspended to free memory."), remedy.Element->first.c_str()));
+                                control->Request(PluginHost::IStateControl::RESUME);
+                            }
+                            control->Release();
+                        }
+                    } else {
+                        MonitorObject::stage stage(remedy.Stage);
+                        bool applied = false;
+
+                        while ((stage != MonitorObject::stage::RESTART) && ((applied = Apply(stage, *plugin)) == false)) {
+                            stage = info.Escalate(stage);
+                        }
+
+                        if (stage != remedy.Stage) {
+                            info.Remedied(stage);
+                        }
+
+                        if (applied == true) {
+                            const string message("{\"callsign\": \"" + plugin->Callsign() + "\", \"action\": \"" + StageName(stage) + "\", \"reason\": \"" + remedy.Reason + "\" }");
+                            SYSLOG(Logging::Notification, (_T("%s: %s, trying: %s."), remedy.Reason, plugin->Callsign().c_str(), StageName(stage)));
+
+                            _service->Notify(message);
+
+                            _parent.event_action(plugin->Callsign(), StageName(stage), remedy.Reason);
+                        } else {
+                            Deactivate(plugin, PluginHost::IShell::MEMORY_EXCEEDED);
+                        }
+                    }
+
+                    plugin->Release();
+                }
+            }
+            static bool Apply(const MonitorObject::stage stage, PluginHost::IShell& plugin)
+            {
+                bool applied = false;
 
-                MonitorObjectContainer::iterator index(_monitor.begin());
+                if (stage == MonitorObject::stage::RECLAIM) {
+                    Exchange::IWebBrowser* browser = plugin.QueryInterface<Exchange::IWebBrowser>();
 
-                // Go through the list of pending observations...
-                while (index != _monitor.end()) {
-                    MonitorObject& info(index->second);
-                    if (info.IsActive() == false) {
-                        ++index;
-                        continue;
+                    if (browser != nullptr) {
+                        applied = (browser->CollectGarbage() == Core::ERROR_NONE);
+                        browser->Release();
                     }
+                } else {
+                    ASSERT(stage == MonitorObject::stage::SUSPEND);
 
-                    if (info.TimeSlot() <= scheduledTime) {
-                        uint32_t value(info.Evaluate());
+                    PluginHost::IStateControl* control = plugin.QueryInterface<PluginHost::IStateControl>();
 
-                        if ((value & (MonitorObject::NOT_OPERATIONAL | MonitorObject::EXCEEDED_MEMORY)) != 0) {
-                            PluginHost::IShell* plugin(_service->QueryInterfaceByCallsign<PluginHost::IShell>(index->first));
+                    if (control != nullptr) {
+                        applied = ((control->State() == PluginHost::IStateControl::RESUMED) && (control->Request(PluginHost::IStateControl::SUSPEND) == Core::ERROR_NONE));
+                        control->Release();
+                    }
+                }
 
-                            if (plugin != nullptr) {
-                                Core::EnumerateType<PluginHost::IShell::reason> why(((value & MonitorObject::EXCEEDED_MEMORY) != 0) ? PluginHost::IShell::MEMORY_EXCEEDED : PluginHost::IShell::FAILURE);
+                return (applied);
+            }
 
-                                const string message("{\"callsign\": \"" + plugin->Callsign() + "\", \"action\": \"Deactivate\", \"reason\": \"" + why.Data() + "\" }");
-                                SYSLOG(Logging::Fatal, (_T("FORCED Shutdown: %s by reason: %s."), plugin->Callsign().c_str(), why.Data()));
+            void Deactivate(PluginHost::IShell* plugin, const PluginHost::IShell::reason reason)
+            {
+                Core::EnumerateType<PluginHost::IShell::reason> why(reason);
 
-                                _service->Notify(message);
+                const string message("{\"callsign\": \"" + plugin->Callsign() + "\", \"action\": \"Deactivate\", \"reason\": \"" + why.Data() + "\" }");
+                SYSLOG(Logging::Fatal, (_T("FORCED Shutdown: %s by reason: %s."), plugin->Callsign().c_str(), why.Data()));
+
+                _service->Notify(message);
+
+                _parent.event_action(plugin->Callsign(), "Deactivate", why.Data());
+
+                Core::IWorkerPool::Instance().Submit(PluginHost::IShell::Job::Create(plugin, PluginHost::IShell::DEACTIVATED, why.Value()));
+            }
+
+            inline bool IsBudgeted() const
+            {
+                return (_budget.IsSet());
+            }
+
+            // MemAvailable as estimated by the kernel, unknown is reported as plenty.
+            static uint64_t Available()
+            {
+                uint64_t result = static_cast<uint64_t>(~0);
+#ifndef __WINDOWS__
+                FILE* file = fopen("/proc/meminfo", "r");
+
+                if (file != nullptr) {
+                    char line[128];
+
+                    while (fgets(line, sizeof(line), file) != nullptr) {
+                        if (strncmp(line, "MemAvailable:", 13) == 0) {
+                            result = static_cast<uint64_t>(strtoull(&line[13], nullptr, 10)) * 1024;
+                            break;
+                        }
+                    }
+
+                    fclose(file);
+                }
+#endif
+                return (result);
+            }
+
+            struct Candidate {
+                std::pair<const string, MonitorObject>* Element;
+                PluginHost::IShell* Plugin;
+                uint64_t Resident;
+                uint8_t Priority;
+                bool Idle;
+            };
+            struct MoreExpendable {
+                bool operator()(const Candidate& lhs, const Candidate& rhs) const
+                {
+                    return ((lhs.Priority != rhs.Priority) ? (lhs.Priority < rhs.Priority) :
+                            (lhs.Idle != rhs.Idle)         ? (lhs.Idle == true) :
+                                                             (lhs.Resident > rhs.Resident));
+                }
+            };
+
+            // Weigh the memory of all observees against the system wide budget. Once exceeded, the least important
+            // observees, idle ones first, are remedied until their memory covers the excess. Nobody else is picked
+            // while the effect of a remedy is still to be measured, so a single incident is not paid for twice.
+            // Observees on their way to a restart no longer count, their memory is about to be given back.
+            // Returns true if a remedy was picked, which moves the time the observee is measured again.
+            bool Arbitrate(const uint64_t now)
+            {
+                uint64_t total = 0;
+                bool pending = false;
+                bool escalated = false;
+
+                ASSERT(_candidates.empty() == true);
+
+                for (std::pair<const string, MonitorObject>& element : _monitor) {
+                    MonitorObject& info(element.second);
+
+                    if ((info.IsActive() == true) && (info.Resident() != 0) && (info.Stage() != MonitorObject::stage::RESTART)) {
+                        total += info.Resident();
+                        pending = pending || info.InGrace(now);
+
+                        _candidates.push_back({ &element, nullptr, info.Resident(), info.Priority(), false });
+                    }
+                }
+
+                const uint64_t available(_budget.Reserve() != 0 ? Available() : static_cast<uint64_t>(~0));
+                const uint64_t excess = _budget.Excess(total, available);
+
+                if (excess == 0) {
+                    // Within budget is not enough to give the memory back, the plugins would just claim it again.
+                    if (_budget.Met(total, available) == true) {
+                        for (const Candidate& candidate : _candidates) {
+                            MonitorObject& info(candidate.Element->second);
+
+                            if ((info.IsOverBudget() == true) && (info.InGrace(now) == false)) {
+                                Resolve(*candidate.Element, _T("Memory budget met again"));
+                            }
+                        }
+                    }
+                } else if (pending == false) {
+                    SYSLOG(Logging::Notification, (_T("Memory budget exceeded by %llu KB."), static_cast<unsigned long long>(excess / 1024)));
+
+                    for (Candidate& candidate : _candidates) {
+                        candidate.Plugin = _service->QueryInterfaceByCallsign<PluginHost::IShell>(candidate.Element->first);
+
+                        if (candidate.Plugin != nullptr) {
+                            PluginHost::IStateControl* control = candidate.Plugin->QueryInterface<PluginHost::IStateControl>();
+
+                            if (control != nullptr) {
+                                candidate.Idle = (control->State() == PluginHost::IStateControl::SUSPENDED);
+                                control->Release();
+                            }
+                        }
+                    }
+
+                    std::sort(_candidates.begin(), _candidates.end(), MoreExpendable());
+
+                    uint64_t covered = 0;
 
-                                _parent.event_action(plugin->Callsign(), "Deactivate", why.Data());
+                    for (const Candidate& candidate : _candidates) {
+                        if ((covered < excess) && (candidate.Plugin != nullptr)) {
+                            MonitorObject& info(candidate.Element->second);
 
-                                Core::IWorkerPool::Instance().Submit(PluginHost::IShell::Job::Create(plugin, PluginHost::IShell::DEACTIVATED, why.Value()));
+                            info.OverBudget();
 
-                                plugin->Release();
+                            if (Escalate(*candidate.Element, now, _T("BudgetExceeded")) == false) {
+                                Deactivate(candidate.Plugin, PluginHost::IShell::MEMORY_EXCEEDED);
                             }
+
+                            escalated = true;
+
+                            covered += candidate.Resident;
                         }
-                        info.Retrigger(scheduledTime);
                     }
 
-                    if (info.TimeSlot() < nextSlot) {
-                        nextSlot = info.TimeSlot();
+                    for (const Candidate& candidate : _candidates) {
+                        if (candidate.Plugin != nullptr) {
+                            candidate.Plugin->Release();
+                        }
+                    }
+                }
+
+                _candidates.clear();
+
+                return (escalated);
+            }
+
+            void Dispatch()
+            {
+                uint64_t scheduledTime(Core::Time::Now().Ticks());
+                uint64_t nextSlot(static_cast<uint64_t>(~0));
+
+                ASSERT(_due.empty() == true);
+
+                // Only pick what is due, the rest of the observees are not even touched...
+                // Deactivated observees are not removed from the schedule right away, they are dropped when they come due.
+                std::pair<const string, MonitorObject>* element;
+
+                _scheduleLock.Lock();
+                while ((element = _schedule.Pop(scheduledTime)) != nullptr) {
+                    if (element->second.IsActive() == false) {
+                        element->second.Scheduled(false);
+                    } else {
+                        _due.push_back(element);
+                    }
+                }
+                _scheduleLock.Unlock();
+
+                for (std::pair<const string, MonitorObject>* element : _due) {
+                    MonitorObject& info(element->second);
+
+                    uint32_t value(info.Evaluate(scheduledTime));
+
+                    // Already on its way to a restart, do not act on it (and count the incident) again.
+                    if (info.Stage() == MonitorObject::stage::RESTART) {
+                        value = 0;
+                    }
+
+                    if ((value & MonitorObject::RESOLVED_MEMORY) != 0) {
+                        Resolve(*element, _T("Memory back within limits"));
                     }
 
-                    index++;
+                    // Not being operational or leaking descriptors/threads can only be cured by a restart, too much memory might be cured by a lighter remedy.
+                    if (((value & (MonitorObject::NOT_OPERATIONAL | MonitorObject::EXCEEDED_RESOURCES)) != 0) || (((value & MonitorObject::EXCEEDED_MEMORY) != 0) && (Escalate(*element, scheduledTime, _T("MemoryExceeded")) == false))) {
+                        PluginHost::IShell* plugin(_service->QueryInterfaceByCallsign<PluginHost::IShell>(element->first));
+
+                        if (plugin != nullptr) {
+                            Deactivate(plugin, ((value & MonitorObject::EXCEEDED_MEMORY) != 0) ? PluginHost::IShell::MEMORY_EXCEEDED : PluginHost::IShell::FAILURE);
+                            plugin->Release();
+                        }
+                    }
+                }
+
+                const bool rekey((_due.empty() == false) && (IsBudgeted() == true) && (Arbitrate(scheduledTime) == true));
+
+                _scheduleLock.Lock();
+                for (std::pair<const string, MonitorObject>* due : _due) {
+                    _schedule.Push(due->second.TimeSlot(), due);
+                }
+                if (rekey == true) {
+                    // The arbiter might have picked observees that were not due, their grace period changed when
+                    // they are measured next. Rare enough to simply rebuild the heap.
+                    _schedule.Rekey([](const std::pair<const string, MonitorObject>& entry) { return (entry.second.TimeSlot()); });
                 }
+                nextSlot = _schedule.Next();
+                _scheduleLock.Unlock();
+
+                if (_due.empty() == false) {
+                    Render(_due);
+                }
+
+                _due.clear();
 
                 if (nextSlot != static_cast<uint64_t>(~0)) {
                     if (nextSlot < Core::Time::Now().Ticks()) {
@@ -958,6 +2497,204 @@ POP_WARNING()
                 }
             }
 
+            // What is rendered of a measurement. It is only recomputed when the observee is measured again.
+            struct Statistics {
+                uint64_t Min;
+                uint64_t Max;
+                uint64_t Average;
+                uint64_t Last;
+                uint64_t P50;
+                uint64_t P90;
+                uint64_t P99;
+                uint64_t P999;
+            };
+
+            struct Sample {
+                const string* Callsign;
+                const MonitorObject* Object;
+                bool Measured;
+                uint32_t Measurements;
+                Statistics Resident;
+                Statistics Allocated;
+                Statistics Shared;
+                Statistics Process;
+                Statistics Descriptors;
+                Statistics Threads;
+            };
+
+            template <typename T>
+            static void Summarize(const Core::MeasurementType<T>& value, const Histogram<T>& distribution, Statistics& result)
+            {
+                result.Min = value.Min();
+                result.Max = value.Max();
+                result.Average = value.Average();
+                result.Last = value.Last();
+                result.P50 = distribution.Percentile(5000);
+                result.P90 = distribution.Percentile(9000);
+                result.P99 = distribution.Percentile(9900);
+                result.P999 = distribution.Percentile(9990);
+            }
+            // Called with the render lock taken.
+            void Refresh(const MonitorObject& info)
+            {
+                Sample& sample(_samples[info.Index()]);
+
+                ASSERT(sample.Object == &info);
+
+                info.Visit([&sample](const MetaData& data) {
+                    sample.Measured = data.HasMeasurements();
+                    sample.Measurements = data.Allocated().Measurements();
+
+                    if (sample.Measured == true) {
+                        Summarize(data.Resident(), data.ResidentHistogram(), sample.Resident);
+                        Summarize(data.Allocated(), data.AllocatedHistogram(), sample.Allocated);
+                        Summarize(data.Shared(), data.SharedHistogram(), sample.Shared);
+                        Summarize(data.Process(), data.ProcessHistogram(), sample.Process);
+                        Summarize(data.Descriptors(), data.DescriptorsHistogram(), sample.Descriptors);
+                        Summarize(data.Threads(), data.ThreadsHistogram(), sample.Threads);
+                    }
+                });
+            }
+            void Render(const MonitorObject& changed)
+            {
+                _renderLock.Lock();
+                Refresh(changed);
+                Compose();
+                _renderLock.Unlock();
+            }
+            void Render(const std::vector<std::pair<const string, MonitorObject>*>& changed)
+            {
+                _renderLock.Lock();
+                for (const std::pair<const string, MonitorObject>* element : changed) {
+                    Refresh(element->second);
+                }
+                Compose();
+                _renderLock.Unlock();
+            }
+
+            // Rendered in the Prometheus text format (version 0.0.4), as that is what scrapers expect for text/plain.
+            void Compose()
+            {
+                // Clearing a string keeps its capacity, after the first few renders this does not allocate anymore.
+                _scratch.clear();
+
+                RenderMeasurement(_T("thunder_monitor_resident_bytes"), _T("Resident memory of the plugin processes in bytes."), &Sample::Resident);
+                RenderMeasurement(_T("thunder_monitor_allocated_bytes"), _T("Allocated memory of the plugin processes in bytes."), &Sample::Allocated);
+                RenderMeasurement(_T("thunder_monitor_shared_bytes"), _T("Shared memory of the plugin processes in bytes."), &Sample::Shared);
+                RenderMeasurement(_T("thunder_monitor_processes"), _T("Number of processes of the plugin."), &Sample::Process);
+                RenderMeasurement(_T("thunder_monitor_descriptors"), _T("Number of open file descriptors of the plugin processes."), &Sample::Descriptors);
+                RenderMeasurement(_T("thunder_monitor_threads"), _T("Number of threads of the plugin processes."), &Sample::Threads);
+
+                RenderHeader(_T("thunder_monitor_measurements_total"), _T("counter"), _T("Number of measurements taken since the last reset."));
+                for (const Sample& sample : _samples) {
+                    RenderLine(_T("thunder_monitor_measurements_total"), *sample.Callsign, nullptr, nullptr, sample.Measurements);
+                }
+                RenderHeader(_T("thunder_monitor_memory_limit_bytes"), _T("gauge"), _T("Resident memory limit of the plugin in bytes."));
+                for (const Sample& sample : _samples) {
+                    if (sample.Object->MemoryThreshold() != 0) {
+                        RenderLine(_T("thunder_monitor_memory_limit_bytes"), *sample.Callsign, nullptr, nullptr, sample.Object->MemoryThreshold());
+                    }
+                }
+                RenderHeader(_T("thunder_monitor_descriptor_limit"), _T("gauge"), _T("Open file descriptor limit of the plugin."));
+                for (const Sample& sample : _samples) {
+                    if (sample.Object->DescriptorLimit() != 0) {
+                        RenderLine(_T("thunder_monitor_descriptor_limit"), *sample.Callsign, nullptr, nullptr, sample.Object->DescriptorLimit());
+                    }
+                }
+                RenderHeader(_T("thunder_monitor_thread_limit"), _T("gauge"), _T("Thread limit of the plugin."));
+                for (const Sample& sample : _samples) {
+                    if (sample.Object->ThreadLimit() != 0) {
+                        RenderLine(_T("thunder_monitor_thread_limit"), *sample.Callsign, nullptr, nullptr, sample.Object->ThreadLimit());
+                    }
+                }
+                RenderHeader(_T("thunder_monitor_memory_interval_milliseconds"), _T("gauge"), _T("Current interval between memory measurements in milliseconds."));
+                for (const Sample& sample : _samples) {
+                    if (sample.Object->MemoryInterval() != 0) {
+                        RenderLine(_T("thunder_monitor_memory_interval_milliseconds"), *sample.Callsign, nullptr, nullptr, sample.Object->MemoryInterval() / Core::Time::MicroSecondsPerMilliSecond);
+                    }
+                }
+                RenderHeader(_T("thunder_monitor_restarts_total"), _T("counter"), _T("Number of automatic restarts of the plugin."));
+                for (const Sample& sample : _samples) {
+                    RenderLine(_T("thunder_monitor_restarts_total"), *sample.Callsign, nullptr, nullptr, sample.Object->Restarts());
+                }
+                RenderHeader(_T("thunder_monitor_incidents_total"), _T("counter"), _T("Number of memory incidents per remedy that resolved them."));
+                for (const Sample& sample : _samples) {
+                    RenderLine(_T("thunder_monitor_incidents_total"), *sample.Callsign, _T("stage"), _T("reclaim"), sample.Object->Incidents(MonitorObject::stage::RECLAIM));
+                    RenderLine(_T("thunder_monitor_incidents_total"), *sample.Callsign, _T("stage"), _T("suspend"), sample.Object->Incidents(MonitorObject::stage::SUSPEND));
+                    RenderLine(_T("thunder_monitor_incidents_total"), *sample.Callsign, _T("stage"), _T("restart"), sample.Object->Incidents(MonitorObject::stage::RESTART));
+                }
+                RenderHeader(_T("thunder_monitor_active"), _T("gauge"), _T("Whether the plugin is activated."));
+                for (const Sample& sample : _samples) {
+                    RenderLine(_T("thunder_monitor_active"), *sample.Callsign, nullptr, nullptr, (sample.Object->IsActive() == true ? 1 : 0));
+                }
+                RenderHeader(_T("thunder_monitor_operational"), _T("gauge"), _T("Whether the plugin reported to be operational."));
+                for (const Sample& sample : _samples) {
+                    RenderLine(_T("thunder_monitor_operational"), *sample.Callsign, nullptr, nullptr, (sample.Object->Operational() != 0 ? 1 : 0));
+                }
+
+                _metricsLock.Lock();
+                _metrics.swap(_scratch);
+                _metricsLock.Unlock();
+            }
+            void RenderMeasurement(const TCHAR name[], const TCHAR help[], Statistics Sample::*statistics)
+            {
+                RenderHeader(name, _T("gauge"), help);
+
+                for (const Sample& sample : _samples) {
+                    if (sample.Measured == true) {
+                        const Statistics& value(sample.*statistics);
+                        RenderLine(name, *sample.Callsign, _T("stat"), _T("min"), value.Min);
+                        RenderLine(name, *sample.Callsign, _T("stat"), _T("max"), value.Max);
+                        RenderLine(name, *sample.Callsign, _T("stat"), _T("average"), value.Average);
+                        RenderLine(name, *sample.Callsign, _T("stat"), _T("last"), value.Last);
+                        RenderLine(name, *sample.Callsign, _T("stat"), _T("p50"), value.P50);
+                        RenderLine(name, *sample.Callsign, _T("stat"), _T("p90"), value.P90);
+                        RenderLine(name, *sample.Callsign, _T("stat"), _T("p99"), value.P99);
+                        RenderLine(name, *sample.Callsign, _T("stat"), _T("p999"), value.P999);
+                    }
+                }
+            }
+            void RenderHeader(const TCHAR name[], const TCHAR type[], const TCHAR help[])
+            {
+                _scratch += _T("# HELP ");
+                _scratch += name;
+                _scratch += ' ';
+                _scratch += help;
+                _scratch += _T("\n# TYPE ");
+                _scratch += name;
+                _scratch += ' ';
+                _scratch += type;
+                _scratch += '\n';
+            }
+            void RenderLine(const TCHAR name[], const string& callsign, const TCHAR key[], const TCHAR label[], const uint64_t value)
+            {
+                char number[24];
+
+                _scratch += name;
+                _scratch += _T("{callsign=\"");
+                for (const TCHAR c : callsign) {
+                    if ((c == '\\') || (c == '"')) {
+                        _scratch += '\\';
+                        _scratch += c;
+                    } else if (c == '\n') {
+                        _scratch += _T("\\n");
+                    } else {
+                        _scratch += c;
+                    }
+                }
+                if (key != nullptr) {
+                    _scratch += _T("\",");
+                    _scratch += key;
+                    _scratch += _T("=\"");
+                    _scratch += label;
+                }
+                _scratch += _T("\"} ");
+
+                snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(value));
+                _scratch += number;
+                _scratch += '\n';
+            }
+
         private:
             template <typename T>
             void translate(const Core::MeasurementType<T>& from, JsonData::Monitor::MeasurementInfo* to) const
@@ -974,6 +2711,18 @@ POP_WARNING()
             using MonitorObjectContainer = std::unordered_map<string, MonitorObject>;
 
             MonitorObjectContainer _monitor;
+            ScheduleType<std::pair<const string, MonitorObject>> _schedule;
+            std::vector<std::pair<const string, MonitorObject>*> _due; // only used in the job
+            Core::CriticalSection _scheduleLock;
+            std::vector<Sample> _samples; // only used while rendering
+            string _scratch; // only used while rendering
+            string _metrics;
+            Core::CriticalSection _renderLock;
+            mutable Core::CriticalSection _metricsLock;
+            BudgetType _budget;
+            RestartLog _log;
+            std::vector<Candidate> _candidates; // only used in the job
+            Remedies _remedies;
             Core::WorkerPool::JobType<MonitorObjects&> _job;
             PluginHost::IShell* _service;
             Monitor& _parent;
@@ -1040,6 +2789,7 @@ POP_WARNING()
         uint32_t endpoint_restartlimits(const JsonData::Monitor::RestartlimitsParamsData& params);
         uint32_t endpoint_resetstats(const JsonData::Monitor::ResetstatsParamsData& params, JsonData::Monitor::InfoInfo& response);
         uint32_t get_status(const string& index, Core::JSON::ArrayType<JsonData::Monitor::InfoInfo>& response) const;
+        uint32_t get_history(const string& index, Core::JSON::ArrayType<History>& response) const;
         void event_action(const string& callsign, const string& action, const string& reason);
     };
 }
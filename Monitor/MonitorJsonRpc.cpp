@@ -35,6 +35,7 @@ namespace Plugin {
         Register<RestartlimitsParamsData,void>(_T("restartlimits"), &Monitor::endpoint_restartlimits, this);
         Register<ResetstatsParamsData,InfoInfo>(_T("resetstats"), &Monitor::endpoint_resetstats, this);
         Property<Core::JSON::ArrayType<InfoInfo>>(_T("status"), &Monitor::get_status, nullptr, this);
+        Property<Core::JSON::ArrayType<History>>(_T("history"), &Monitor::get_history, nullptr, this);
     }
 
     void Monitor::UnregisterAll()
@@ -42,6 +43,7 @@ namespace Plugin {
         Unregister(_T("resetstats"));
         Unregister(_T("restartlimits"));
         Unregister(_T("status"));
+        Unregister(_T("history"));
     }
 
     // API implementation
@@ -85,6 +87,16 @@ namespace Plugin {
         return Core::ERROR_NONE;
     }
 
+    // Property: history - The failures acted upon, also those of earlier runs, either for a single plugin or all plugins watched by the Monitor
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t Monitor::get_history(const string& index, Core::JSON::ArrayType<History>& response) const
+    {
+        const string& callsign = index;
+        _monitor.RestartHistory(callsign, response);
+        return Core::ERROR_NONE;
+    }
+
     // Event: action - Signals action taken by the monitor
     void Monitor::event_action(const string& callsign, const string& action, const string& reason)
     {
@@ -0,0 +1,117 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_SCHEDULE_H
+#define __MONITOR_SCHEDULE_H
+
+// Deliberately free of framework dependencies, so the benchmark can exercise it on its own.
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Thunder {
+namespace Plugin {
+
+    // Entries are queued with the time they are due; the earliest one is at the top of the heap.
+    // The schedule does not lock, that is up to its owner.
+    template <typename ELEMENT>
+    class ScheduleType {
+    private:
+        struct Slot {
+            uint64_t Time;
+            ELEMENT* Element;
+        };
+        struct LaterSlot {
+            bool operator()(const Slot& lhs, const Slot& rhs) const
+            {
+                return (lhs.Time > rhs.Time);
+            }
+        };
+
+    public:
+        ScheduleType(const ScheduleType&) = delete;
+        ScheduleType& operator=(const ScheduleType&) = delete;
+
+        ScheduleType()
+            : _slots()
+        {
+        }
+        ~ScheduleType() = default;
+
+    public:
+        // Reserve all we could ever need up front, so (re)scheduling never allocates.
+        inline void Reserve(const size_t size)
+        {
+            _slots.reserve(size);
+        }
+        inline void Clear()
+        {
+            _slots.clear();
+        }
+        inline bool IsEmpty() const
+        {
+            return (_slots.empty());
+        }
+        // Time the earliest entry is due, ~0 if nothing is scheduled.
+        inline uint64_t Next() const
+        {
+            return (_slots.empty() == true ? static_cast<uint64_t>(~0) : _slots.front().Time);
+        }
+        // Returns true if the element became the earliest one.
+        bool Push(const uint64_t time, ELEMENT* element)
+        {
+            _slots.push_back({ time, element });
+            std::push_heap(_slots.begin(), _slots.end(), LaterSlot());
+
+            return (_slots.front().Element == element);
+        }
+        // Takes the earliest entry if it is due, nullptr if nothing is.
+        ELEMENT* Pop(const uint64_t now)
+        {
+            ELEMENT* result = nullptr;
+
+            if ((_slots.empty() == false) && (_slots.front().Time <= now)) {
+                result = _slots.front().Element;
+
+                std::pop_heap(_slots.begin(), _slots.end(), LaterSlot());
+                _slots.pop_back();
+            }
+
+            return (result);
+        }
+        // Times of entries that are not due changed, look them all up again and rebuild the heap.
+        template <typename TIMESLOT>
+        void Rekey(TIMESLOT&& timeSlot)
+        {
+            for (Slot& slot : _slots) {
+                slot.Time = timeSlot(*slot.Element);
+            }
+
+            std::make_heap(_slots.begin(), _slots.end(), LaterSlot());
+        }
+
+    private:
+        std::vector<Slot> _slots;
+    };
+
+} // namespace Plugin
+} // namespace Thunder
+
+#endif // __MONITOR_SCHEDULE_H
@@ -0,0 +1,144 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares the heap based schedule of the Monitor against visiting every observee on each dispatch,
+// for a few hundred observees with mixed intervals. The observees live in the same kind of container as in the
+// Monitor. Time is simulated, only the bookkeeping is measured.
+//
+//     SchedulerBenchmark [observees] [dispatches]
+
+#include "../Schedule.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+    struct Observee {
+        uint64_t Interval;
+        uint64_t Next;
+    };
+
+    using Observees = std::unordered_map<std::string, Observee>;
+
+    Observees Populate(const uint32_t count)
+    {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<uint32_t> seconds(1, 60);
+        Observees result;
+
+        for (uint32_t index = 0; index < count; index++) {
+            const uint64_t interval = seconds(generator) * 1000000ULL;
+            result.emplace("Plugin" + std::to_string(index), Observee{ interval, interval });
+        }
+
+        return (result);
+    }
+
+    uint64_t Heap(Observees& observees, const uint32_t dispatches, uint64_t& visited)
+    {
+        Thunder::Plugin::ScheduleType<Observee> schedule;
+        std::vector<Observee*> due;
+
+        schedule.Reserve(observees.size());
+        due.reserve(observees.size());
+
+        for (std::pair<const std::string, Observee>& observee : observees) {
+            schedule.Push(observee.second.Next, &observee.second);
+        }
+
+        uint64_t now = 0;
+
+        for (uint32_t index = 0; index < dispatches; index++) {
+            Observee* observee;
+
+            now = schedule.Next();
+
+            while ((observee = schedule.Pop(now)) != nullptr) {
+                due.push_back(observee);
+            }
+            for (Observee* entry : due) {
+                entry->Next += entry->Interval;
+                schedule.Push(entry->Next, entry);
+            }
+
+            visited += due.size();
+            due.clear();
+        }
+
+        return (now);
+    }
+
+    uint64_t Scan(Observees& observees, const uint32_t dispatches, uint64_t& visited)
+    {
+        uint64_t now = 0;
+
+        for (uint32_t index = 0; index < dispatches; index++) {
+            uint64_t next = static_cast<uint64_t>(~0);
+
+            for (const std::pair<const std::string, Observee>& observee : observees) {
+                next = std::min(next, observee.second.Next);
+            }
+
+            now = next;
+
+            for (std::pair<const std::string, Observee>& observee : observees) {
+                if (observee.second.Next <= now) {
+                    observee.second.Next += observee.second.Interval;
+                }
+            }
+
+            visited += observees.size();
+        }
+
+        return (now);
+    }
+
+    template <typename RUN>
+    void Measure(const char name[], const uint32_t count, const uint32_t dispatches, RUN&& run)
+    {
+        Observees observees(Populate(count));
+        uint64_t visited = 0;
+
+        const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+        const uint64_t end = run(observees, dispatches, visited);
+        const std::chrono::steady_clock::time_point stop(std::chrono::steady_clock::now());
+
+        const double nanoseconds = std::chrono::duration<double, std::nano>(stop - start).count();
+
+        printf("%-6s %6u observees: %9.1f ns/dispatch, %7.1f observees touched/dispatch (simulated %llu s)\n",
+            name, count, nanoseconds / dispatches, static_cast<double>(visited) / dispatches, static_cast<unsigned long long>(end / 1000000));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const uint32_t count = (argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 300);
+    const uint32_t dispatches = (argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 100000);
+
+    Measure("heap", count, dispatches, Heap);
+    Measure("scan", count, dispatches, Scan);
+
+    return (0);
+}
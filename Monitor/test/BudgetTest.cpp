@@ -0,0 +1,139 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Replays the budget arbitration of the Monitor for a plugin that frees part of its memory while suspended and
+// claims it again once resumed. Without a headroom it is suspended and resumed on every other measurement, with
+// a headroom it stays suspended until the rest of the system gives up enough memory.
+// Returns non zero if any check fails.
+
+#include "../Budget.h"
+
+#include <cstdio>
+
+namespace {
+
+    using Budget = Thunder::Plugin::BudgetType;
+
+    constexpr uint64_t MB = 1024 * 1024;
+    constexpr uint64_t Resumed = 100 * MB;
+    constexpr uint64_t Suspended = 30 * MB;
+
+    uint32_t failures = 0;
+
+    void Check(const bool condition, const char description[])
+    {
+        if (condition == false) {
+            printf("FAILED: %s\n", description);
+            failures++;
+        }
+    }
+
+    class Arbiter {
+    public:
+        Arbiter(const Budget& budget)
+            : _budget(budget)
+            , _suspended(false)
+            , _transitions(0)
+        {
+        }
+
+    public:
+        bool IsSuspended() const
+        {
+            return (_suspended);
+        }
+        uint32_t Transitions() const
+        {
+            return (_transitions);
+        }
+        // One measurement of all observees, the same decision as Monitor::Arbitrate().
+        void Measure(const uint64_t others)
+        {
+            const uint64_t total = others + (_suspended == true ? Suspended : Resumed);
+            const uint64_t available = static_cast<uint64_t>(~0);
+
+            if (_budget.Excess(total, available) != 0) {
+                if (_suspended == false) {
+                    _suspended = true;
+                    _transitions++;
+                }
+            } else if ((_suspended == true) && (_budget.Met(total, available) == true)) {
+                _suspended = false;
+                _transitions++;
+            }
+        }
+
+    private:
+        const Budget _budget;
+        bool _suspended;
+        uint32_t _transitions;
+    };
+
+    void Replay(Arbiter& arbiter, const uint64_t others, const uint32_t measurements)
+    {
+        for (uint32_t index = 0; index < measurements; index++) {
+            arbiter.Measure(others);
+        }
+    }
+
+} // namespace
+
+int main()
+{
+    // The others use 950 MB: 1050 MB with the plugin resumed, 980 MB with it suspended, against a 1000 MB limit.
+    Arbiter oscillating(Budget(1000 * MB, 0, 0));
+    Replay(oscillating, 950 * MB, 20);
+
+    Check(oscillating.Transitions() == 20, "without headroom the plugin is suspended and resumed on every measurement");
+
+    Arbiter stable(Budget(1000 * MB, 0, 64 * MB));
+    Replay(stable, 950 * MB, 20);
+
+    Check(stable.Transitions() == 1, "with headroom the plugin is suspended once");
+    Check(stable.IsSuspended() == true, "with headroom the plugin stays suspended while the budget is tight");
+
+    // 930 MB is within budget, but not the headroom below it.
+    Replay(stable, 910 * MB, 5);
+
+    Check(stable.IsSuspended() == true, "the plugin stays suspended within the headroom");
+
+    // The others gave up memory, the plugin fits again, also once it claimed its memory back.
+    Replay(stable, 850 * MB, 20);
+
+    Check(stable.IsSuspended() == false, "the plugin is resumed once usage dropped below the headroom");
+    Check(stable.Transitions() == 2, "the plugin is resumed once");
+
+    // The same for the memory the system should keep available.
+    const Budget reserve(0, 200 * MB, 64 * MB);
+
+    Check(reserve.Excess(0, 150 * MB) == 50 * MB, "excess covers the missing reserve");
+    Check(reserve.Excess(0, 220 * MB) == 0, "nothing in excess above the reserve");
+    Check(reserve.Met(0, 220 * MB) == false, "reserve is not met within the headroom");
+    Check(reserve.Met(0, 264 * MB) == true, "reserve is met above the headroom");
+
+    const Budget unlimited;
+
+    Check(unlimited.IsSet() == false, "no budget configured");
+    Check(unlimited.Excess(~0ULL, 0) == 0, "nothing is in excess of no budget");
+    Check(unlimited.Met(~0ULL, 0) == true, "no budget is always met");
+
+    printf("%s: %u failure(s)\n", (failures == 0 ? "PASSED" : "FAILED"), failures);
+
+    return (failures == 0 ? 0 : 1);
+}
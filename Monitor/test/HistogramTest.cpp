@@ -0,0 +1,104 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Merges the histograms of two measurement intervals and checks the percentiles against those of a single
+// histogram that saw all measurements, and against the exact values within the documented precision.
+// Returns non zero if any check fails.
+
+#include "../Histogram.h"
+
+#include <cstdio>
+
+namespace {
+
+    using Histogram = Thunder::Plugin::HistogramType<uint64_t>;
+
+    uint32_t failures = 0;
+
+    void Check(const bool condition, const char description[])
+    {
+        if (condition == false) {
+            printf("FAILED: %s\n", description);
+            failures++;
+        }
+    }
+
+    // Within the 6.25% the bucketing promises.
+    bool Close(const uint64_t value, const uint64_t expected)
+    {
+        const uint64_t difference = (value > expected ? value - expected : expected - value);
+
+        return ((difference * 16) <= expected);
+    }
+
+} // namespace
+
+int main()
+{
+    Histogram first;
+    Histogram second;
+    Histogram all;
+
+    // The first interval measured a quiet system, the second one a busy system.
+    for (uint64_t value = 1; value <= 1000; value++) {
+        first.Set(value);
+        all.Set(value);
+    }
+    for (uint64_t value = 1001; value <= 4000; value++) {
+        second.Set(value * 10);
+        all.Set(value * 10);
+    }
+
+    Histogram merged(first);
+    merged.Merge(second);
+
+    Check(merged.Measurements() == 4000, "merged histogram counts the measurements of both intervals");
+
+    const uint16_t percentiles[] = { 0, 1, 2500, 5000, 9000, 9900, 10000 };
+
+    for (const uint16_t permyriad : percentiles) {
+        Check(merged.Percentile(permyriad) == all.Percentile(permyriad), "merged percentile equals the percentile over all measurements");
+    }
+
+    // A quarter of the measurements came from the quiet interval.
+    Check(Close(merged.Percentile(2500), 1000), "p25 lies at the end of the first interval");
+    Check(Close(merged.Percentile(5000), 20000), "p50 lies in the second interval");
+    Check(Close(merged.Percentile(9900), 39600), "p99 lies at the end of the second interval");
+    Check(Close(merged.Percentile(10000), 40000), "p100 is the largest measurement");
+
+    // The interval histograms themselves are left alone.
+    Check(first.Measurements() == 1000, "first interval is not changed by the merge");
+    Check(Close(first.Percentile(5000), 500), "p50 of the first interval");
+    Check(Close(second.Percentile(5000), 25000), "p50 of the second interval");
+
+    // Merging nothing changes nothing, merging into nothing copies.
+    Histogram empty;
+    Histogram unchanged(merged);
+    unchanged.Merge(empty);
+    empty.Merge(merged);
+
+    for (const uint16_t permyriad : percentiles) {
+        Check(unchanged.Percentile(permyriad) == merged.Percentile(permyriad), "merging an empty histogram keeps the percentiles");
+        Check(empty.Percentile(permyriad) == merged.Percentile(permyriad), "merging into an empty histogram copies the percentiles");
+    }
+
+    printf("%s: %u failure(s)\n", (failures == 0 ? "PASSED" : "FAILED"), failures);
+
+    return (failures == 0 ? 0 : 1);
+}
@@ -24,6 +24,9 @@
 #include <interfaces/IOCDM.h>
 #include "Protobuf.h"
 
+#include <array>
+#include <atomic>
+
 namespace Thunder {
 namespace Plugin {
 
@@ -111,7 +114,185 @@ namespace Plugin {
             uint32_t _systems;
         };
 
-        typedef Core::IteratorType<const std::list<KeyId>, const KeyId&, std::list<KeyId>::const_iterator> Iterator;
+        // The first key ids are stored inline, as most init data holds only a few. More keys, e.g. rotated in on
+        // a live stream, spill into chunks on the heap. Chunks are linked, never reallocated, so adding a key never
+        // moves the others. So the key a status update returns and the iterators over the keys stay valid while the
+        // CDM reports (rotated) keys from its own thread. Keys are only added, by one thread at a time, the count is
+        // published after the key is in place.
+        class KeyIdList {
+        private:
+            static constexpr uint8_t ChunkSize = 8;
+
+            struct Chunk {
+                Chunk()
+                    : Keys()
+                    , Next(nullptr)
+                {
+                }
+
+                std::array<KeyId, ChunkSize> Keys;
+                std::atomic<Chunk*> Next;
+            };
+
+        public:
+            class const_iterator {
+            public:
+                const_iterator()
+                    : _chunk(nullptr)
+                    , _position(0)
+                {
+                }
+                const_iterator(const Chunk* chunk, const uint32_t position)
+                    : _chunk(chunk)
+                    , _position(position)
+                {
+                }
+                const_iterator(const const_iterator&) = default;
+                const_iterator& operator=(const const_iterator&) = default;
+                ~const_iterator() = default;
+
+            public:
+                inline const KeyId& operator*() const
+                {
+                    return (_chunk->Keys[_position % ChunkSize]);
+                }
+                inline const KeyId* operator->() const
+                {
+                    return (&(_chunk->Keys[_position % ChunkSize]));
+                }
+                // Stepping onto the end might step into a chunk that is not there (yet), it is not dereferenced.
+                inline const_iterator& operator++()
+                {
+                    _position++;
+                    if ((_position % ChunkSize) == 0) {
+                        _chunk = _chunk->Next.load(std::memory_order_acquire);
+                    }
+                    return (*this);
+                }
+                inline const_iterator operator++(int)
+                {
+                    const_iterator result(*this);
+                    operator++();
+                    return (result);
+                }
+                // The position alone tells, the end does not know its chunk.
+                inline bool operator==(const const_iterator& rhs) const
+                {
+                    return (_position == rhs._position);
+                }
+                inline bool operator!=(const const_iterator& rhs) const
+                {
+                    return (!operator==(rhs));
+                }
+
+            private:
+                const Chunk* _chunk;
+                uint32_t _position;
+            };
+
+        public:
+            KeyIdList& operator=(const KeyIdList&) = delete;
+
+            KeyIdList()
+                : _first()
+                , _last(&_first)
+                , _count(0)
+            {
+            }
+            KeyIdList(const KeyIdList& copy)
+                : _first()
+                , _last(&_first)
+                , _count(0)
+            {
+                const_iterator index(copy.begin());
+                const const_iterator last(copy.end());
+
+                while (index != last) {
+                    Add(*index);
+                    index++;
+                }
+            }
+            ~KeyIdList()
+            {
+                Chunk* chunk = _first.Next.load(std::memory_order_relaxed);
+
+                while (chunk != nullptr) {
+                    Chunk* next = chunk->Next.load(std::memory_order_relaxed);
+                    delete chunk;
+                    chunk = next;
+                }
+            }
+
+        public:
+            inline const_iterator begin() const
+            {
+                return (const_iterator(&_first, 0));
+            }
+            // Keys added after the end was taken are not visited.
+            inline const_iterator end() const
+            {
+                return (const_iterator(nullptr, _count.load(std::memory_order_acquire)));
+            }
+            inline size_t size() const
+            {
+                return (_count.load(std::memory_order_acquire));
+            }
+            inline bool empty() const
+            {
+                return (size() == 0);
+            }
+            KeyId* Find(const Exchange::KeyId& key)
+            {
+                KeyId* result = nullptr;
+                uint32_t count = _count.load(std::memory_order_acquire);
+                Chunk* chunk = &_first;
+
+                while ((count != 0) && (result == nullptr)) {
+                    const uint8_t used = static_cast<uint8_t>(std::min(count, static_cast<uint32_t>(ChunkSize)));
+                    uint8_t index = 0;
+
+                    while ((index < used) && (chunk->Keys[index] != key)) {
+                        index++;
+                    }
+
+                    if (index < used) {
+                        result = &(chunk->Keys[index]);
+                    } else {
+                        count -= used;
+                        chunk = chunk->Next.load(std::memory_order_acquire);
+                    }
+                }
+
+                return (result);
+            }
+            inline const KeyId* Find(const Exchange::KeyId& key) const
+            {
+                return (const_cast<KeyIdList*>(this)->Find(key));
+            }
+            KeyId* Add(const KeyId& key)
+            {
+                const uint32_t count = _count.load(std::memory_order_relaxed);
+                const uint8_t index = static_cast<uint8_t>(count % ChunkSize);
+
+                if ((index == 0) && (count != 0)) {
+                    Chunk* chunk = new Chunk();
+                    _last->Next.store(chunk, std::memory_order_release);
+                    _last = chunk;
+                }
+
+                _last->Keys[index] = key;
+                _count.store(count + 1, std::memory_order_release);
+
+                return (&(_last->Keys[index]));
+            }
+
+        private:
+            Chunk _first;
+            Chunk* _last; // only used by the thread adding keys
+            std::atomic<uint32_t> _count;
+        };
+
+        typedef Core::IteratorType<const KeyIdList, const KeyId&, KeyIdList::const_iterator> Iterator;
 
     public:
         CommonEncryptionData(const uint8_t data[], const uint16_t length)
@@ -130,15 +311,15 @@ namespace Plugin {
     public:
         inline Exchange::ISession::KeyStatus Status() const
         {
-            return (_keyIds.size() > 0 ? _keyIds.begin()->Status() : Exchange::ISession::StatusPending);
+            return (_keyIds.empty() == false ? _keyIds.begin()->Status() : Exchange::ISession::StatusPending);
         }
         inline Exchange::ISession::KeyStatus Status(const KeyId& key) const
         {
             Exchange::ISession::KeyStatus result(Exchange::ISession::StatusPending);
             if (key.IsValid() == true) {
-                std::list<KeyId>::const_iterator index(std::find(_keyIds.begin(), _keyIds.end(), key));
-                if (index != _keyIds.end()) {
-                    result = index->Status();
+                const KeyId* entry = _keyIds.Find(key);
+                if (entry != nullptr) {
+                    result = entry->Status();
                 }
             }
             return (result);
@@ -149,35 +330,31 @@ namespace Plugin {
         }
         inline bool HasKeyId(const Exchange::KeyId& keyId) const
         {
-            return (std::find(_keyIds.begin(), _keyIds.end(), keyId) != _keyIds.end());
+            return (_keyIds.Find(keyId) != nullptr);
         }
         inline void AddKeyId(const KeyId& key)
         {
-            std::list<KeyId>::iterator index(std::find(_keyIds.begin(), _keyIds.end(), key));
+            KeyId* entry = _keyIds.Find(key);
 
-            if (index == _keyIds.end()) {
+            if (entry == nullptr) {
+                _keyIds.Add(key);
                 TRACE(Trace::Information, (_T("Added key: %s for system: %02X"), key.ToString().c_str(), key.Systems()));
-                _keyIds.emplace_back(key);
             } else {
                 TRACE(Trace::Information, (_T("Updated key: %s for system: %02X"), key.ToString().c_str(), key.Systems()));
-                index->Flag(key.Systems());
+                entry->Flag(key.Systems());
             }
         }
         inline const KeyId* UpdateKeyStatus(Exchange::ISession::KeyStatus status, const KeyId& key)
         {
-            KeyId* entry = nullptr;
-
             ASSERT(key.IsValid() == true);
 
-            std::list<KeyId>::iterator index(std::find(_keyIds.begin(), _keyIds.end(), key));
+            KeyId* entry = _keyIds.Find(key);
 
-            if (index == _keyIds.end()) {
+            if (entry == nullptr) {
+                entry = _keyIds.Add(key);
                 TRACE(Trace::Information, (_T("Added key: %s for system: %02X"), key.ToString().c_str(), key.Systems()));
-                _keyIds.emplace_back(key);
-                entry = &(_keyIds.back());
-            } else {
-                entry = &(*index);
             }
+
             entry->Status(status);
 
             return (entry);
@@ -186,16 +363,11 @@ namespace Plugin {
         {
 
             bool result = true;
-            std::list<KeyId>::const_iterator requested(keys._keyIds.begin());
-
-            while ((requested != keys._keyIds.end()) && (result == true)) {
-                std::list<KeyId>::const_iterator index(_keyIds.begin());
+            KeyIdList::const_iterator requested(keys._keyIds.begin());
+            const KeyIdList::const_iterator last(keys._keyIds.end());
 
-                while ((index != _keyIds.end()) && (*index != *requested)) {
-                    index++;
-                }
-
-                result = (index != _keyIds.end());
+            while ((requested != last) && (result == true)) {
+                result = (_keyIds.Find(*requested) != nullptr);
 
                 requested++;
             }
@@ -253,31 +425,32 @@ namespace Plugin {
             return (filler);
         }
 
+        // Walks the init data once, without copying it. Every read is checked against the length first, init data
+        // comes straight from the (untrusted) media.
         void Parse(const uint8_t data[], const uint16_t length)
         {
             uint16_t offset = 0;
 
             do {
                 // Check if this is a PSSH box...
-                uint32_t sizeBE = ((data[offset] << 24) | (data[offset + 1] << 16) | (data[offset + 2] << 8) | data[offset + 3]);
-                if ((sizeBE <= static_cast<uint32_t>(length - offset)) && ((length - offset) >= 4)
-                        && (::memcmp(&(data[offset + 4]), PSSHeader, 4) == 0)) {
+                const uint16_t remaining = (length - offset);
+                const uint32_t sizeBE = (remaining >= 8 ? ((data[offset] << 24) | (data[offset + 1] << 16) | (data[offset + 2] << 8) | data[offset + 3]) : 0);
+                if ((sizeBE >= 8) && (sizeBE <= remaining) && (::memcmp(&(data[offset + 4]), PSSHeader, 4) == 0)) {
                     TRACE(Trace::Information, (_T("Initdata contains a PSSH box")));
-                    ParsePSSHBox(&(data[offset + 4 + 4]), (sizeBE - 4 - 4));
-                    offset += sizeBE;
+                    ParsePSSHBox(&(data[offset + 4 + 4]), static_cast<uint16_t>(sizeBE - 4 - 4));
+                    offset += static_cast<uint16_t>(sizeBE);
                 } else if (offset == 0) {
-                    uint32_t sizeLE = (data[offset] | (data[offset + 1] << 8) | (data[offset + 2] << 16) | (data[offset + 3] << 24));
-                    if ((data[0] == '<') && (data[2] == 'W') && (data[4] == 'R') && (data[6] == 'M')) {
+                    if ((length >= 7) && (data[0] == '<') && (data[2] == 'W') && (data[4] == 'R') && (data[6] == 'M')) {
                         // Playready XML data without PSSH header and withouth Playready Rights Managment Header
                         TRACE(Trace::Information, (_T("Initdata contains Playready XML data")));
                         ParseXMLBox(data, length);
                         offset = length;
-                    } else if (std::string(reinterpret_cast<const char*>(data), length).find(JSONKeyIds) != std::string::npos) {
+                    } else if (std::search(data, data + length, JSONKeyIds, JSONKeyIds + ::strlen(JSONKeyIds)) != (data + length)) {
                         // keyids initdata type
                         TRACE(Trace::Information, (_T("Initdata contains ClearKey key IDs")));
                         ParseJSONInitData(reinterpret_cast<const char*>(data), length);
                         offset = length;
-                    } else if (sizeLE == length) {
+                    } else if ((length >= 4) && (static_cast<uint32_t>(data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24)) == length)) {
                         // Seems like it is an XMLBlob, without PSSH header, we have seen that on PlayReady only..
                         TRACE(Trace::Information, (_T("Initdata contains Playready PSSH payload")));
                         if (ParsePlayReadyPSSHData(&data[offset], length) == true) {
@@ -312,22 +485,24 @@ namespace Plugin {
                     return ((ptr[0] << 24) | (ptr[1] << 16) | (ptr[2] << 8) | ptr[3]);
                 };
 
+                // Sizes are calculated in 64 bits, the 32 bit counts in the box could make them wrap around.
                 if (version == 0) {
                     psshData = &data[PSSH_HEADER_SIZE_V0];
                     psshDataSize = Read32BE(psshData - 4);
-                    if ((psshDataSize + PSSH_HEADER_SIZE_V0) > length) {
+                    if ((static_cast<uint64_t>(psshDataSize) + PSSH_HEADER_SIZE_V0) > length) {
                         psshData = nullptr;
                     }
-                } else if (version == 1) {
+                } else if ((version == 1) && (length >= PSSH_HEADER_SIZE_V1)) {
                     /* Version 1 inserts raw key IDs before DRM system specific payload. */
                     keyIdData = &data[PSSH_HEADER_SIZE_V0];
                     keyIdCount = Read32BE(keyIdData - 4);
-                    if (((keyIdCount * KeyId::Length()) + PSSH_HEADER_SIZE_V1) > length) {
+                    const uint64_t keyIdSize = static_cast<uint64_t>(keyIdCount) * KeyId::Length();
+                    if ((keyIdSize + PSSH_HEADER_SIZE_V1) > length) {
                         keyIdData = nullptr;
                     } else {
-                        psshData = &data[PSSH_HEADER_SIZE_V1 + (keyIdCount * KeyId::Length())];
+                        psshData = &data[PSSH_HEADER_SIZE_V1 + keyIdSize];
                         psshDataSize = Read32BE(psshData - 4);
-                        if (psshDataSize + PSSH_HEADER_SIZE_V1 + (keyIdCount * KeyId::Length()) > length) {
+                        if ((static_cast<uint64_t>(psshDataSize) + PSSH_HEADER_SIZE_V1 + keyIdSize) > length) {
                             psshData = nullptr;
                         }
                     }
@@ -373,108 +548,113 @@ namespace Plugin {
             }
         }
 
-        uint16_t FindInXML(const uint8_t data[], const uint16_t length, const char key[], const uint8_t keyLength)
+        // Finds the UTF-16LE encoded (ASCII) key in [from, to) of the data, only at even offsets. Returns its offset,
+        // or to if it is not there. Candidates are found with memchr, not by walking all characters.
+        uint16_t FindInXML(const uint8_t data[], uint16_t from, const uint16_t to, const char key[], const uint8_t keyLength) const
         {
-            uint8_t index = 0;
-            uint16_t result = 0;
+            const uint32_t needed = (keyLength * 2);
+            uint16_t result = to;
 
-            while ((result <= length) && (index < keyLength)) {
-                if (static_cast<uint8_t>(key[index]) == data[result]) {
-                    index++;
-                    result += 2;
-                } else if (index > 0) {
-                    result -= ((index - 1) * 2);
-                    index = 0;
+            while (((from + needed) <= to) && (result == to)) {
+                const uint8_t* hit = static_cast<const uint8_t*>(::memchr(&(data[from]), key[0], (to - needed) - from + 1));
+
+                if (hit == nullptr) {
+                    from = to;
                 } else {
-                    result += 2;
+                    from = static_cast<uint16_t>(hit - data);
+
+                    if ((from % 2) != 0) {
+                        from++;
+                    } else {
+                        uint8_t index = 0;
+
+                        while ((index < keyLength) && (data[from + (index * 2)] == static_cast<uint8_t>(key[index])) && (data[from + (index * 2) + 1] == 0)) {
+                            index++;
+                        }
+
+                        if (index == keyLength) {
+                            result = from;
+                        } else {
+                            from += 2;
+                        }
+                    }
                 }
             }
-            return ((index == keyLength) ? (result - (keyLength * 2)) : result);
+
+            return (result);
         }
 
         void ParseXMLBox(const uint8_t data[], const uint16_t length)
         {
-                uint16_t begin;
-                const uint8_t* slot = data;
-                uint16_t size = length;
-
-                // Now find the string <KID> in this text
-                // this will process  PlayReady header format v.4.0.0.0
-                // https://docs.microsoft.com/en-us/playready/specifications/playready-header-specification#36-v4000
-                //
-                // we want to find and process this utf16 string:
-                // <KID>q5HgCTj40kGeNVhTH9Gexw==</KID>
-                //
-                while ((size > 0) && ((begin = FindInXML(slot, size, "<KID>", 5)) < size)) {
-                    uint16_t end = FindInXML(&(slot[begin + 10]), size - begin - 10, "</KID>", 6);
-
-                    if (end < (size - begin - 10)) {
-                        uint8_t byteArray[32];
-
-                        // We got a KID, translate it
-                        if (Base64(&(slot[begin + 10]), static_cast<uint8_t>(end), byteArray, sizeof(byteArray)) == KeyId::Length()) {
-                            // Pass it the microsoft way :-(
-                            uint32_t a = byteArray[0];
-                            a = (a << 8) | byteArray[1];
-                            a = (a << 8) | byteArray[2];
-                            a = (a << 8) | byteArray[3];
-                            uint16_t b = byteArray[4];
-                            b = (b << 8) | byteArray[5];
-                            uint16_t c = byteArray[6];
-                            c = (c << 8) | byteArray[7];
-                            uint8_t* d = &byteArray[8];
-
-                            // Add them in both endiannesses, since we have encountered both in the wild.
-                            AddKeyId(KeyId(PLAYREADY, a, b, c, d));
-                        }
-                        size -= (begin + 10 + end + 12);
-                        slot += (begin + 10 + end + 12);
-                    } else {
-                        size = 0;
-                    }
+            // Only the even part of the data is UTF-16.
+            const uint16_t size = (length & ~1);
+            uint16_t offset = 0;
+            uint16_t begin;
+
+            // This will process PlayReady header format v.4.0.0.0
+            // https://docs.microsoft.com/en-us/playready/specifications/playready-header-specification#36-v4000
+            //
+            //     <KID>q5HgCTj40kGeNVhTH9Gexw==</KID>
+            //
+            // and PlayReady header format v.4.1.0.0/v.4.2.0.0/v.4.3.0.0
+            // https://docs.microsoft.com/en-us/playready/specifications/playready-header-specification#35-v4100
+            // https://docs.microsoft.com/en-us/playready/specifications/playready-header-specification#34-v4200
+            // https://docs.microsoft.com/en-us/playready/specifications/playready-header-specification#33-v4300
+            //
+            //     <KID ALGID="AESCTR" CHECKSUM="xNvWVxoWk04=" VALUE="0IbHou/5s0yzM80yOkKEpQ=="></KID>
+            //
+            while ((begin = FindInXML(data, offset, size, "<KID", 4)) < size) {
+                const uint16_t tag = (begin + 8);
+                const uint16_t close = FindInXML(data, tag, size, "</KID>", 6);
+
+                if (close == size) {
+                    break;
                 }
 
-                // this will process PlayReady header format v.4.1.0.0/v.4.2.0.0/v.4.3.0.0
-                // https://docs.microsoft.com/en-us/playready/specifications/playready-header-specification#35-v4100
-                // https://docs.microsoft.com/en-us/playready/specifications/playready-header-specification#34-v4200
-                // https://docs.microsoft.com/en-us/playready/specifications/playready-header-specification#33-v4300
-                //
-                // we want to find and process this utf16 string:
-                // <KID ALGID="AESCTR" CHECKSUM="xNvWVxoWk04=" VALUE="0IbHou/5s0yzM80yOkKEpQ=="></KID>
-                //
-                // Now find the string "<KID " in this text
-                while ((size > 0) && ((begin = FindInXML(slot, size, "<KID ", 5)) < size)) {
-                    uint16_t end = FindInXML(&(slot[begin + 10]), size - begin - 10, "</KID>", 6);
-
-                    uint16_t keyValue = FindInXML(&(slot[begin + 10]), end, "VALUE", 5);
-                    uint16_t keyStart = FindInXML(&(slot[begin + 10 + keyValue + 10]), end - keyValue - 10, "\"", 1) + 2;
-                    uint16_t keyLength = FindInXML(&(slot[begin + 10 + keyValue + 10 + keyStart]), end - keyValue - 10 - keyStart - 2, "\"", 1) - 2;
-
-                    if (end < (size - begin - 10)) {
-                        uint8_t byteArray[32];
-
-                        // We got a KID, translate its
-                        if (Base64(&(slot[begin + 10 + keyValue + 10 + keyStart]), static_cast<uint8_t>(keyLength), byteArray, sizeof(byteArray)) == KeyId::Length()) {
-                            // Pass it the microsoft way :-(
-                            uint32_t a = byteArray[0];
-                            a = (a << 8) | byteArray[1];
-                            a = (a << 8) | byteArray[2];
-                            a = (a << 8) | byteArray[3];
-                            uint16_t b = byteArray[4];
-                            b = (b << 8) | byteArray[5];
-                            uint16_t c = byteArray[6];
-                            c = (c << 8) | byteArray[7];
-                            uint8_t* d = &byteArray[8];
-
-                            // Add them in both endiannesses, since we have encountered both in the wild.
-                            AddKeyId(KeyId(PLAYREADY, a, b, c, d));
-                        }
-                        size -= (begin + 10 + end + 12);
-                        slot += (begin + 10 + end + 12);
-                    } else {
-                        size = 0;
+                uint16_t valueStart = 0;
+                uint16_t valueEnd = 0;
+                bool found = false;
+
+                if (data[tag] == '>') {
+                    valueStart = (tag + 2);
+                    valueEnd = close;
+                    found = true;
+                } else if (data[tag] == ' ') {
+                    const uint16_t tagEnd = FindInXML(data, tag, close, ">", 1);
+                    const uint16_t value = FindInXML(data, tag, tagEnd, "VALUE=\"", 7);
+
+                    if (value < tagEnd) {
+                        valueStart = (value + 14);
+                        valueEnd = FindInXML(data, valueStart, tagEnd, "\"", 1);
+                        found = (valueEnd < tagEnd);
                     }
+                } else {
+                    // Something like <KIDS>, the KIDs are inside.
+                    offset = tag;
+                    continue;
+                }
+
+                uint8_t byteArray[32];
+
+                // We got a KID, translate it
+                if ((found == true) && ((valueEnd - valueStart) < 0xFF)
+                    && (Base64(&(data[valueStart]), static_cast<uint8_t>(valueEnd - valueStart), byteArray, sizeof(byteArray)) == KeyId::Length())) {
+                    // Pass it the microsoft way :-(
+                    uint32_t a = byteArray[0];
+                    a = (a << 8) | byteArray[1];
+                    a = (a << 8) | byteArray[2];
+                    a = (a << 8) | byteArray[3];
+                    uint16_t b = byteArray[4];
+                    b = (b << 8) | byteArray[5];
+                    uint16_t c = byteArray[6];
+                    c = (c << 8) | byteArray[7];
+                    uint8_t* d = &byteArray[8];
+
+                    AddKeyId(KeyId(PLAYREADY, a, b, c, d));
                 }
+
+                offset = (close + 12);
+            }
         }
 
         using JSONStringArray = Core::JSON::ArrayType<Core::JSON::String>;
@@ -520,18 +700,18 @@ namespace Plugin {
 
             bool result = false;
 
-            uint32_t size = Read32LE(data);
+            const uint8_t* dataEnd = (data + length);
+            uint32_t size = (length >= 6 ? Read32LE(data) : static_cast<uint32_t>(~0));
             data += 4;
             if (size == length) {
                 uint16_t count = Read16LE(data);
                 if (count > 0) {
-                    const uint8_t* dataEnd = (data + length);
                     data += 2;
-                    while ((data + 4) < dataEnd) {
+                    while ((data + 4) <= dataEnd) {
                         const uint16_t recordType = Read16LE(data);
                         const uint16_t recordLength = Read16LE(data + 2);
                         data += 4;
-                        if ((data + recordLength) >= dataEnd) {
+                        if ((data + recordLength) > dataEnd) {
                             break;
                         }
                         if (recordType == 1 /* rights management */) {
@@ -605,7 +785,7 @@ namespace Plugin {
         }
 
     private:
-        std::list<KeyId> _keyIds;
+        KeyIdList _keyIds;
     };
 }
 } // namespace Thunder::Plugin
@@ -0,0 +1,164 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DECRYPTBATCH_H
+#define __DECRYPTBATCH_H
+
+#include <core/core.h>
+#include <interfaces/IDRM.h>
+
+#include <array>
+#include <cstddef>
+
+namespace Thunder {
+namespace Plugin {
+
+    // A session buffer normally carries a single sample, described by the administration of the buffer itself.
+    // To decrypt several (small) samples with a single RequestConsume/Consumed handshake, a client leaves the IV
+    // and the subsamples in the administration empty and writes a batch into the payload instead:
+    //
+    //   Header | Sample[Count] | subsample tables and sample data, wherever the offsets point to
+    //
+    // All offsets are relative to the start of the payload. Every sample is decrypted in place, its Length and
+    // Status are updated with the result. The stream properties (and with that the media type) of the buffer
+    // apply to all samples in the batch.
+    //
+    // This class is not Thread Safe, it works on the buffer of a single session. It is meant to be usable by clients
+    // as well, so it is installed with the development headers.
+    class DecryptBatch {
+    public:
+        static constexpr uint32_t Magic = 0x5443424F; // "OBCT"
+        static constexpr uint16_t Version = 1;
+        static constexpr uint8_t MaxIVLength = 16;
+        static constexpr uint8_t MaxKeyIdLength = 16;
+
+        struct Header {
+            uint32_t Magic;
+            uint16_t Version;
+            uint16_t Count;
+        };
+
+        struct Sample {
+            uint32_t Offset;
+            uint32_t Length; // in: encrypted bytes, out: clear bytes
+            uint32_t Status; // out: result of decrypting this sample
+            uint32_t SubSamples; // offset of SubSampleCount CDMi::SubSampleInfo entries
+            uint8_t SubSampleCount;
+            uint8_t Scheme;
+            uint8_t EncryptedBlocks;
+            uint8_t ClearBlocks;
+            uint8_t IVLength;
+            uint8_t KeyIdLength;
+            uint8_t Reserved[2];
+            uint8_t IV[MaxIVLength];
+            uint8_t KeyId[MaxKeyIdLength];
+        };
+
+        static_assert(sizeof(Header) == 8, "The batch header is shared with the client, its layout is fixed");
+        static_assert(sizeof(Sample) == 56, "The batch sample is shared with the client, its layout is fixed");
+
+    public:
+        DecryptBatch() = delete;
+        DecryptBatch(const DecryptBatch&) = delete;
+        DecryptBatch& operator=(const DecryptBatch&) = delete;
+
+        DecryptBatch(uint8_t buffer[], const uint32_t size)
+            : _buffer(buffer)
+            , _size(size)
+            , _count(0)
+            , _subSamples()
+        {
+            if ((buffer != nullptr) && (size >= sizeof(Header))) {
+                Header header;
+                ::memcpy(&header, buffer, sizeof(Header));
+
+                if ((header.Magic == Magic) && (header.Version == Version) && (header.Count != 0) && (TableEnd(header.Count) <= size)) {
+                    _count = header.Count;
+                }
+            }
+        }
+        ~DecryptBatch() = default;
+
+    public:
+        bool IsValid() const
+        {
+            return (_count != 0);
+        }
+        uint16_t Count() const
+        {
+            return (_count);
+        }
+        // The client shares the buffer and might change it at any moment. So the sample (and its subsamples) is
+        // copied out and the copy is validated, only the copy is to be used from here on.
+        bool Get(const uint16_t index, Sample& sample)
+        {
+            ASSERT(index < _count);
+
+            ::memcpy(&sample, &(_buffer[sizeof(Header) + (static_cast<uint32_t>(index) * sizeof(Sample))]), sizeof(Sample));
+
+            const uint64_t tableEnd = TableEnd(_count);
+            const uint64_t subSamplesEnd = sample.SubSamples + (static_cast<uint64_t>(sample.SubSampleCount) * sizeof(CDMi::SubSampleInfo));
+
+            const bool valid = (sample.Offset >= tableEnd) && ((static_cast<uint64_t>(sample.Offset) + sample.Length) <= _size)
+                && (sample.IVLength <= MaxIVLength) && (sample.KeyIdLength <= MaxKeyIdLength)
+                && ((sample.SubSampleCount == 0) || ((sample.SubSamples >= tableEnd) && (subSamplesEnd <= _size)));
+
+            if ((valid == true) && (sample.SubSampleCount != 0)) {
+                ::memcpy(_subSamples.data(), &(_buffer[sample.SubSamples]), sample.SubSampleCount * sizeof(CDMi::SubSampleInfo));
+            }
+
+            return (valid);
+        }
+        // Only the outcome is written back, the rest of the sample belongs to the client.
+        void Set(const uint16_t index, const Sample& sample)
+        {
+            ASSERT(index < _count);
+
+            uint8_t* destination = &(_buffer[sizeof(Header) + (static_cast<uint32_t>(index) * sizeof(Sample))]);
+
+            ::memcpy(&(destination[offsetof(Sample, Length)]), &(sample.Length), sizeof(sample.Length));
+            ::memcpy(&(destination[offsetof(Sample, Status)]), &(sample.Status), sizeof(sample.Status));
+        }
+        // Only valid for the sample last validated by Get().
+        uint8_t* Data(const Sample& sample)
+        {
+            return (&(_buffer[sample.Offset]));
+        }
+        CDMi::SubSampleInfo* SubSamples(const Sample& sample)
+        {
+            return (sample.SubSampleCount != 0 ? _subSamples.data() : nullptr);
+        }
+
+    private:
+        static uint64_t TableEnd(const uint16_t count)
+        {
+            return (sizeof(Header) + (static_cast<uint64_t>(count) * sizeof(Sample)));
+        }
+
+    private:
+        uint8_t* _buffer;
+        const uint32_t _size;
+        uint16_t _count;
+        std::array<CDMi::SubSampleInfo, 255> _subSamples;
+    };
+
+} // namespace Plugin
+} // namespace Thunder
+
+#endif // __DECRYPTBATCH_H
@@ -19,10 +19,13 @@
 
 #include <regex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "Module.h"
 #include "CENCParser.h"
+#include "DecryptBatch.h"
 
 // Get in the definitions required for access to the sepcific
 // DRM engines.
@@ -30,6 +33,11 @@
 #include <interfaces/IContentDecryption.h>
 #include <interfaces/IOCDM.h>
 
+#ifdef ENABLE_METRICS_REGISTRY
+// Installed by the PerformanceMetrics plugin, which reads the values.
+#include <metrics/MetricsRegistry.h>
+#endif
+
 extern "C" {
 
 typedef ::CDMi::ISystemFactory* (*GetDRMSystemFunction)();
@@ -41,11 +49,11 @@ namespace Plugin {
 
     static void TrimWs(const std::string& str, size_t& start, size_t& end)
     {
-        while(std::isspace(str[start]) && start < end) {
+        while(start < end && std::isspace(static_cast<unsigned char>(str[start]))) {
             ++start;
         }
 
-        while(std::isspace(str[end - 1]) && end - 1 > 0) {
+        while(end > start && std::isspace(static_cast<unsigned char>(str[end - 1]))) {
          --end;
         }
     }
@@ -70,19 +78,88 @@ namespace Plugin {
         return tokens;
     }
 
+    // Same as matching against \s*([a-zA-Z0-9\-\+]+/[a-zA-Z0-9\-\+]+)\s*(;\s*codecs\*?\s*=\s*"?([a-zA-Z0-9,\s\+\-\.']+)"?\s*)?
+    // but without building (and running) a regular expression for every call.
     static void ParseContentType(const std::string& contentType, std::string& mimeType, std::vector<std::string>& codecsList) {
         codecsList.clear();
         if (contentType.empty() == false) {
-            std::smatch matches;
-            const size_t kCaptureGroupsNumber = 4;
-            std::regex expr("\\s*([a-zA-Z0-9\\-\\+]+/[a-zA-Z0-9\\-\\+]+)\\s*(;\\s*codecs\\*?\\s*=\\s*\"?([a-zA-Z0-9,\\s\\+\\-\\.']+)\"?\\s*)?");
-            bool matched = std::regex_match(contentType, matches, expr, std::regex_constants::match_default);
-
-            if (matched && matches.size() == kCaptureGroupsNumber) {
-                ASSERT(matches[0] == contentType);
-                mimeType = matches[1];
-                if (matches[2].str().empty() == false) {
-                    std::vector<std::string> codecs = Tokenize(matches[3], ',');
+            const size_t length = contentType.length();
+            size_t position = 0;
+
+            auto IsTypeCharacter = [](const char c) -> bool {
+                return ((std::isalnum(static_cast<unsigned char>(c)) != 0) || (c == '-') || (c == '+'));
+            };
+            auto IsCodecCharacter = [](const char c) -> bool {
+                return ((std::isalnum(static_cast<unsigned char>(c)) != 0) || (std::isspace(static_cast<unsigned char>(c)) != 0) || (c == ',') || (c == '+') || (c == '-') || (c == '.') || (c == '\''));
+            };
+            auto SkipWs = [&]() {
+                while ((position < length) && (std::isspace(static_cast<unsigned char>(contentType[position])) != 0)) {
+                    position++;
+                }
+            };
+            auto Skip = [&](const char c) -> bool {
+                bool skipped = ((position < length) && (contentType[position] == c));
+                if (skipped == true) {
+                    position++;
+                }
+                return (skipped);
+            };
+            auto Span = [&](bool (*valid)(const char)) -> size_t {
+                const size_t begin = position;
+                while ((position < length) && (valid(contentType[position]) == true)) {
+                    position++;
+                }
+                return (position - begin);
+            };
+
+            SkipWs();
+
+            const size_t typeStart = position;
+            bool matched = (Span(IsTypeCharacter) > 0) && (Skip('/') == true) && (Span(IsTypeCharacter) > 0);
+            const size_t typeEnd = position;
+            size_t codecsStart = 0;
+            size_t codecsEnd = 0;
+
+            if (matched == true) {
+                SkipWs();
+
+                if (position < length) {
+                    static const char Codecs[] = "codecs";
+
+                    matched = (Skip(';') == true);
+                    SkipWs();
+                    matched = matched && (contentType.compare(position, sizeof(Codecs) - 1, Codecs) == 0);
+                    if (matched == true) {
+                        position += sizeof(Codecs) - 1;
+                        Skip('*');
+                        SkipWs();
+                        matched = (Skip('=') == true);
+
+                        const size_t equals = position;
+                        SkipWs();
+                        const size_t spaces = position;
+                        Skip('"');
+                        codecsStart = position;
+
+                        if ((Span(IsCodecCharacter) == 0) && (spaces != equals)) {
+                            // White space is a valid value as well, if nothing else follows.
+                            codecsStart = equals;
+                            position = spaces;
+                        }
+
+                        codecsEnd = position;
+                        matched = matched && (codecsEnd != codecsStart);
+                        Skip('"');
+                        SkipWs();
+                        matched = matched && (position == length);
+                    }
+                }
+            }
+
+            if (matched == true) {
+                mimeType = contentType.substr(typeStart, typeEnd - typeStart);
+                if (codecsEnd != codecsStart) {
+                    std::vector<std::string> codecs = Tokenize(contentType.substr(codecsStart, codecsEnd - codecsStart), ',');
                     codecsList.swap(codecs);
                 }
             }
@@ -104,6 +181,21 @@ namespace Plugin {
             CDMi::ISystemFactory* Factory;
         };
 
+        // What the configuration holds for a key system. Loaded is set once the library offering it is done loading,
+        // successfully or not. It is reference counted, a request waiting for it might outlive the configuration.
+        struct SystemConfig {
+            SystemConfig()
+                : Designators()
+                , Configuration()
+                , Loaded(Core::ProxyType<Core::Event>::Create(false, true))
+            {
+            }
+
+            std::list<string> Designators;
+            string Configuration;
+            Core::ProxyType<Core::Event> Loaded;
+        };
+
         class ExternalAccess : public RPC::Communicator {
         public:
             ExternalAccess() = delete;
@@ -158,11 +250,33 @@ namespace Plugin {
                 BufferAdministrator& operator=(const BufferAdministrator&) = delete;
 
             public:
-                BufferAdministrator(const string pathName)
+                // Buffer files are only created once that many buffers are in use concurrently. Released buffers are
+                // handed out again most recent first, as these are the most likely to still be mapped in memory.
+                BufferAdministrator(const string pathName, const uint16_t maximum)
                     : _adminLock()
                     , _basePath(Core::Directory::Normalize(pathName))
-                    , _occupation(0)
+                    , _maximum(maximum)
+                    , _created(0)
+                    , _used(0)
+                    , _peak(0)
+                    , _free()
+#ifdef ENABLE_METRICS_REGISTRY
+                    , _metrics()
+                    , _usedMetric()
+                    , _peakMetric()
+                    , _createdMetric()
+                    , _exhaustedMetric()
+#endif
                 {
+#ifdef ENABLE_METRICS_REGISTRY
+                    if (_metrics.Open(_T("OCDM")) == true) {
+                        _usedMetric = _metrics.AddGauge(_T("buffers.used"));
+                        _peakMetric = _metrics.AddGauge(_T("buffers.peak"));
+                        _createdMetric = _metrics.AddGauge(_T("buffers.created"));
+                        _exhaustedMetric = _metrics.AddCounter(_T("buffers.exhausted"));
+                    }
+#endif
+                    Publish(false);
                 }
                 ~BufferAdministrator()
                 {
@@ -171,23 +285,30 @@ namespace Plugin {
             public:
                 bool AcquireBuffer(string& locator)
                 {
-                    uint8_t index = 0;
-
                     locator.clear();
 
                     _adminLock.Lock();
 
-                    while ((index < (sizeof(_occupation) * 8)) && ((_occupation & (1 << index)) != 0)) {
-                        index++;
-                    }
+                    if ((_free.empty() == false) || (_created < _maximum)) {
+                        uint16_t index;
+
+                        if (_free.empty() == false) {
+                            index = _free.back();
+                            _free.pop_back();
+                        } else {
+                            index = _created++;
+                        }
 
-                    // We do not expect more that 4 buffers to be allocated concurrently,
-                    // so more than X would be dramatic
-                    ASSERT(index < (sizeof(_occupation) * 8));
+                        _used++;
+                        if (_used > _peak) {
+                            _peak = _used;
+                        }
+                        Publish(false);
 
-                    if (index < (sizeof(_occupation) * 8)) {
-                        _occupation |= (1 << index);
-                        locator = _basePath + BufferFileName + Core::NumberType<uint8_t>(index).Text();
+                        locator = _basePath + BufferFileName + Core::NumberType<uint16_t>(index).Text();
+                    } else {
+                        Publish(true);
+                        TRACE(Trace::Error, (_T("All %d decrypt buffers are in use"), _maximum));
                     }
 
                     _adminLock.Unlock();
@@ -205,30 +326,55 @@ namespace Plugin {
 
                         if (actualFile.compare(0, baseLength, BufferFileName) == 0) {
                             // Than the last part is the number..
-                            uint8_t number(Core::NumberType<uint8_t>(&(actualFile.c_str()[baseLength]), static_cast<uint32_t>(actualFile.length() - baseLength)).Value());
+                            uint16_t number(Core::NumberType<uint16_t>(&(actualFile.c_str()[baseLength]), static_cast<uint32_t>(actualFile.length() - baseLength)).Value());
 
-                            if (number <= (sizeof(_occupation) * 8)) {
-                                _adminLock.Lock();
-
-                                if ((_occupation & (1 << number)) != 0) {
-                                    _occupation ^= (1 << number);
-                                    released = true;
-                                } else {
-                                    // Freeing a buffer that is already free sounds dangerous !!!
-                                    ASSERT(false);
-                                }
+                            _adminLock.Lock();
 
-                                _adminLock.Unlock();
+                            if ((number < _created) && (std::find(_free.begin(), _free.end(), number) == _free.end())) {
+                                _free.push_back(number);
+                                _used--;
+                                Publish(false);
+                                released = true;
+                            } else {
+                                // Freeing a buffer that is already free sounds dangerous !!!
+                                ASSERT(false);
                             }
+
+                            _adminLock.Unlock();
                         }
                     }
                     return (released);
                 }
 
+            private:
+                void Publish(VARIABLE_IS_NOT_USED const bool exhausted)
+                {
+#ifdef ENABLE_METRICS_REGISTRY
+                    _usedMetric.Set(_used);
+                    _peakMetric.Set(_peak);
+                    _createdMetric.Set(_created);
+
+                    if (exhausted == true) {
+                        _exhaustedMetric.Increment();
+                    }
+#endif
+                }
+
             private:
                 Core::CriticalSection _adminLock;
                 string _basePath;
-                uint16_t _occupation;
+                uint16_t _maximum;
+                uint16_t _created;
+                uint16_t _used;
+                uint16_t _peak;
+                std::vector<uint16_t> _free;
+#ifdef ENABLE_METRICS_REGISTRY
+                Metrics::Registry _metrics;
+                Metrics::Gauge _usedMetric;
+                Metrics::Gauge _peakMetric;
+                Metrics::Gauge _createdMetric;
+                Metrics::Counter _exhaustedMetric;
+#endif
             };
 
             // IMediaKeys defines the MediaKeys interface.
@@ -311,66 +457,154 @@ namespace Plugin {
 
                         while (IsRunning() == true) {
 
-                            uint32_t clearContentSize = 0;
-                            uint8_t* clearContent = nullptr;
-
                             RequestConsume(Core::infinite);
 
                             if (IsRunning() == true) {
-                                uint8_t *payloadBuffer = Buffer();
-
-                                CDMi::SampleInfo sampleInfo;
-                                sampleInfo.scheme = static_cast<CDMi::EncryptionScheme>(EncScheme());
-                                EncPattern(sampleInfo.pattern.encrypted_blocks,sampleInfo.pattern.clear_blocks);
-                                sampleInfo.iv = const_cast<uint8_t *>(IVKey());
-                                sampleInfo.ivLength = IVKeyLength();
-                                sampleInfo.keyId = const_cast<uint8_t *>(KeyId(sampleInfo.keyIdLength));
-                                sampleInfo.subSample = const_cast<CDMi::SubSampleInfo *>(SubSamples());
-                                sampleInfo.subSampleCount = static_cast<uint8_t>(SubSampleLength());
-
-                                uint16_t width = 0, height = 0;
-                                uint8_t type = 0;
-                                MediaProperties(height, width, type);
-                                const MediaStreamProperties streamProperties(height, width, static_cast<CDMi::MediaType>(type));
-
-                                int cr = 0;
-                                REPORT_DURATION_WARNING(
-                                    {
-                                    cr = _mediaKeys->Decrypt(
-                                        payloadBuffer,
-                                        BytesWritten(),
-                                        &clearContent,
-                                        &clearContentSize,
-                                        const_cast<CDMi::SampleInfo *>(&sampleInfo),
-                                        dynamic_cast<const CDMi::IStreamProperties *>(&streamProperties));
-                                    },
-                                    WarningReporting::TooLongDecrypt
-                                );
-
-                                if ((cr == 0) && (clearContentSize != 0)) {
-                                    if (clearContentSize != BytesWritten()) {
-                                        TRACE(Trace::Information, (_T("Returned clear sample size (%d) differs from encrypted buffer size (%d)"), clearContentSize, BytesWritten()));
-                                        Size(clearContentSize);
-                                    }
-
-                                    if (payloadBuffer != clearContent) {
-                                        // This wasn't a case of in-place decryption. So, make sure the decrypted buffer is copied to memory mapped file and released
-                                        // Adjust the buffer on our side (this process) on what we will write back
-                                        SetBuffer(0, clearContentSize, clearContent);
-                                        //Lets release the clear content buffer
-                                        _mediaKeys->ReleaseClearContent(nullptr, 0,clearContentSize,clearContent);
-                                    }
-                                }
+                                Process();
+                            }
+                        }
+
+                        return (Core::infinite);
+                    }
+                    void Process()
+                    {
+                        uint16_t width = 0, height = 0;
+                        uint8_t type = 0;
+                        MediaProperties(height, width, type);
+                        const MediaStreamProperties streamProperties(height, width, static_cast<CDMi::MediaType>(type));
+
+                        DecryptBatch batch(Buffer(), BytesWritten());
+
+                        // A batch is only recognized if the administration does not describe a sample itself.
+                        if ((IVKeyLength() == 0) && (SubSampleLength() == 0) && (batch.IsValid() == true)) {
+                            Status(DecryptSamples(batch, streamProperties));
+                        } else {
+                            Status(DecryptSample(streamProperties));
+                        }
 
-                                // Store the status we have for the other side.
-                                Status(static_cast<uint32_t>(cr));
+                        // Whatever the result, we are done with the buffer..
+                        Consumed();
+                    }
+                    uint32_t DecryptSample(const MediaStreamProperties& streamProperties)
+                    {
+                        uint32_t clearContentSize = 0;
+                        uint8_t* clearContent = nullptr;
+                        uint8_t *payloadBuffer = Buffer();
+
+                        CDMi::SampleInfo sampleInfo;
+                        sampleInfo.scheme = static_cast<CDMi::EncryptionScheme>(EncScheme());
+                        EncPattern(sampleInfo.pattern.encrypted_blocks,sampleInfo.pattern.clear_blocks);
+                        sampleInfo.iv = const_cast<uint8_t *>(IVKey());
+                        sampleInfo.ivLength = IVKeyLength();
+                        sampleInfo.keyId = const_cast<uint8_t *>(KeyId(sampleInfo.keyIdLength));
+                        sampleInfo.subSample = const_cast<CDMi::SubSampleInfo *>(SubSamples());
+                        sampleInfo.subSampleCount = static_cast<uint8_t>(SubSampleLength());
+
+                        int cr = 0;
+                        REPORT_DURATION_WARNING(
+                            {
+                            cr = _mediaKeys->Decrypt(
+                                payloadBuffer,
+                                BytesWritten(),
+                                &clearContent,
+                                &clearContentSize,
+                                const_cast<CDMi::SampleInfo *>(&sampleInfo),
+                                dynamic_cast<const CDMi::IStreamProperties *>(&streamProperties));
+                            },
+                            WarningReporting::TooLongDecrypt
+                        );
+
+                        if ((cr == 0) && (clearContentSize != 0)) {
+                            if (clearContentSize != BytesWritten()) {
+                                TRACE(Trace::Information, (_T("Returned clear sample size (%d) differs from encrypted buffer size (%d)"), clearContentSize, BytesWritten()));
+                                Size(clearContentSize);
+                            }
 
-                                // Whatever the result, we are done with the buffer..
-                                Consumed();
+                            if (payloadBuffer != clearContent) {
+                                // This wasn't a case of in-place decryption. So, make sure the decrypted buffer is copied to memory mapped file and released
+                                // Adjust the buffer on our side (this process) on what we will write back
+                                SetBuffer(0, clearContentSize, clearContent);
+                                //Lets release the clear content buffer
+                                _mediaKeys->ReleaseClearContent(nullptr, 0,clearContentSize,clearContent);
                             }
                         }
 
-                        return (Core::infinite);
+                        return (static_cast<uint32_t>(cr));
+                    }
+                    // Decrypts all samples of the batch in this single wake-up. The status of the buffer is that of
+                    // the first sample that failed, every sample carries its own status as well.
+                    uint32_t DecryptSamples(DecryptBatch& batch, const MediaStreamProperties& streamProperties)
+                    {
+                        uint32_t result = 0;
+
+                        for (uint16_t index = 0; index < batch.Count(); index++) {
+                            DecryptBatch::Sample sample;
+
+                            if (batch.Get(index, sample) == true) {
+                                sample.Status = DecryptSample(batch, sample, streamProperties);
+                            } else {
+                                TRACE(Trace::Error, (_T("Sample %d of the batch does not fit in the buffer"), index));
+                                sample.Status = static_cast<uint32_t>(CDMi::CDMi_S_FALSE);
+                            }
+
+                            batch.Set(index, sample);
+
+                            if (result == 0) {
+                                result = sample.Status;
+                            }
+                        }
+
+                        return (result);
+                    }
+                    // Works on the validated copy of the sample only, its Length is updated with the clear size.
+                    uint32_t DecryptSample(DecryptBatch& batch, DecryptBatch::Sample& sample, const MediaStreamProperties& streamProperties)
+                    {
+                        uint8_t* payloadBuffer = batch.Data(sample);
+                        uint32_t clearContentSize = 0;
+                        uint8_t* clearContent = nullptr;
+
+                        CDMi::SampleInfo sampleInfo;
+                        sampleInfo.scheme = static_cast<CDMi::EncryptionScheme>(sample.Scheme);
+                        sampleInfo.pattern.encrypted_blocks = sample.EncryptedBlocks;
+                        sampleInfo.pattern.clear_blocks = sample.ClearBlocks;
+                        sampleInfo.iv = sample.IV;
+                        sampleInfo.ivLength = sample.IVLength;
+                        sampleInfo.keyId = sample.KeyId;
+                        sampleInfo.keyIdLength = sample.KeyIdLength;
+                        sampleInfo.subSample = batch.SubSamples(sample);
+                        sampleInfo.subSampleCount = sample.SubSampleCount;
+
+                        int cr = 0;
+                        REPORT_DURATION_WARNING(
+                            {
+                            cr = _mediaKeys->Decrypt(
+                                payloadBuffer,
+                                sample.Length,
+                                &clearContent,
+                                &clearContentSize,
+                                &sampleInfo,
+                                dynamic_cast<const CDMi::IStreamProperties *>(&streamProperties));
+                            },
+                            WarningReporting::TooLongDecrypt
+                        );
+
+                        if ((cr == 0) && (clearContentSize != 0)) {
+                            if (payloadBuffer != clearContent) {
+                                // The clear sample has to fit in the slot of the encrypted one, there is no room to grow.
+                                if (clearContentSize <= sample.Length) {
+                                    ::memcpy(payloadBuffer, clearContent, clearContentSize);
+                                } else {
+                                    TRACE(Trace::Error, (_T("Returned clear sample size (%d) exceeds encrypted sample size (%d)"), clearContentSize, sample.Length));
+                                    cr = static_cast<int>(CDMi::CDMi_S_FALSE);
+                                }
+                                _mediaKeys->ReleaseClearContent(nullptr, 0, clearContentSize, clearContent);
+                            }
+                            if (cr == 0) {
+                                sample.Length = clearContentSize;
+                            }
+                        }
+
+                        return (static_cast<uint32_t>(cr));
                     }
 
                 private:
@@ -458,12 +692,17 @@ namespace Plugin {
                         else
                             key = Exchange::ISession::InternalError;
 
-                        const CommonEncryptionData::KeyId* updated = _parent._cencData.UpdateKeyStatus(key, keyId);
+                        const bool known = _parent._cencData.HasKeyId(keyId);
+                        const CommonEncryptionData::KeyId& updated = *(_parent._cencData.UpdateKeyStatus(key, keyId));
 
-                        ASSERT (updated != nullptr);
+                        if (known == false) {
+                            // Rotated in, make the session findable by this key as well. This only takes the index
+                            // lock, which is never held while calling into the CDM.
+                            _parent._parent.Index(&_parent, updated);
+                        }
 
                         if (_callback != nullptr) {
-                            _callback->OnKeyStatusUpdate(updated->Id(), updated->Length(), key);
+                            _callback->OnKeyStatusUpdate(updated.Id(), updated.Length(), key);
                         }
                     }
                     void Revoke(Exchange::ISession::ICallback* callback)
@@ -565,6 +804,10 @@ POP_WARNING()
                 {
                     return (_cencData.HasKeyId(keyId));
                 }
+                inline CommonEncryptionData::Iterator KeyIds() const
+                {
+                    return (_cencData.Keys());
+                }
                 std::string SessionId() const override
                 {
                     return (_sessionId);
@@ -759,12 +1002,15 @@ POP_WARNING()
             };
 
         public:
-            AccessorOCDM(OCDMImplementation* parent, const string& name, const uint32_t defaultSize)
+            AccessorOCDM(OCDMImplementation* parent, const string& name, const uint32_t defaultSize, const uint16_t buffers)
                 : _parent(*parent)
                 , _adminLock()
-                , _administrator(name)
+                , _administrator(name, buffers)
                 , _defaultSize(defaultSize)
+                , _indexLock()
                 , _sessionList()
+                , _sessionIds()
+                , _keyIds()
             {
                 ASSERT(parent != nullptr);
             }
@@ -856,7 +1102,20 @@ POP_WARNING()
 
                             _adminLock.Lock();
 
-                            _sessionList.push_front(newEntry);
+                            _indexLock.Lock();
+
+                            _sessionList.insert(newEntry);
+
+                            if (sessionId.empty() == false) {
+                                _sessionIds[sessionId] = newEntry;
+                            }
+
+                            CommonEncryptionData::Iterator keys(newEntry->KeyIds());
+                            while (keys.Next() == true) {
+                                Insert(newEntry, keys.Current());
+                            }
+
+                            _indexLock.Unlock();
 
                             if (false == keyIds.IsEmpty()) {
                                 CommonEncryptionData::Iterator index(keyIds.Keys());
@@ -1038,30 +1297,132 @@ POP_WARNING()
             END_INTERFACE_MAP
 
         private:
+            static string Key(const Exchange::KeyId& keyId)
+            {
+                return (string(reinterpret_cast<const char*>(keyId.Id()), keyId.Length()));
+            }
+            // Must be called with the index lock taken.
+            void Insert(SessionImplementation* session, const Exchange::KeyId& keyId)
+            {
+                auto entries(_keyIds.equal_range(Key(keyId)));
+
+                while ((entries.first != entries.second) && (entries.first->second != session)) {
+                    entries.first++;
+                }
+
+                if (entries.first == entries.second) {
+                    _keyIds.emplace(Key(keyId), session);
+                }
+            }
+            // Called from the CDM, while it might hold locks of its own. Only the index lock is taken here, a leaf
+            // lock that is never held while calling into the CDM. A session on its way out is not indexed again.
+            void Index(SessionImplementation* session, const Exchange::KeyId& keyId)
+            {
+                _indexLock.Lock();
+
+                if (_sessionList.find(session) != _sessionList.end()) {
+                    Insert(session, keyId);
+                }
+
+                _indexLock.Unlock();
+            }
+            // Must be called with the index lock taken.
+            void Unindex(SessionImplementation* session)
+            {
+                std::unordered_map<string, SessionImplementation*>::iterator id(_sessionIds.find(session->SessionId()));
+                if ((id != _sessionIds.end()) && (id->second == session)) {
+                    _sessionIds.erase(id);
+                }
+
+                CommonEncryptionData::Iterator keys(session->KeyIds());
+                while (keys.Next() == true) {
+                    auto entries(_keyIds.equal_range(Key(keys.Current())));
+
+                    while (entries.first != entries.second) {
+                        if (entries.first->second == session) {
+                            entries.first = _keyIds.erase(entries.first);
+                        } else {
+                            entries.first++;
+                        }
+                    }
+                }
+            }
             Exchange::ISession* FindSession(const CommonEncryptionData& keyIds, const string& keySystem) const
             {
                 Exchange::ISession* result = nullptr;
 
-                std::list<SessionImplementation*>::const_iterator index(_sessionList.begin());
+                _indexLock.Lock();
 
-                while ((index != _sessionList.end()) && (result == nullptr)) {
+                CommonEncryptionData::Iterator keys(keyIds.Keys());
 
-                    if ((*index)->IsSupported(keyIds, keySystem) == true) {
-                        result = *index;
-                        result->AddRef();
-                    } else {
-                        index++;
+                if (keys.Next() == false) {
+                    // No keys to look for, any session of the key system will do.
+                    std::unordered_set<SessionImplementation*>::const_iterator index(_sessionList.begin());
+
+                    while ((index != _sessionList.end()) && (result == nullptr)) {
+                        if ((*index)->IsSupported(keyIds, keySystem) == true) {
+                            result = *index;
+                            result->AddRef();
+                        } else {
+                            index++;
+                        }
+                    }
+                } else {
+                    // Only the sessions holding the first key can hold all of them.
+                    auto candidates(_keyIds.equal_range(Key(keys.Current())));
+
+                    while ((candidates.first != candidates.second) && (result == nullptr)) {
+                        if (candidates.first->second->IsSupported(keyIds, keySystem) == true) {
+                            result = candidates.first->second;
+                            result->AddRef();
+                        } else {
+                            candidates.first++;
+                        }
                     }
                 }
+
+                _indexLock.Unlock();
+
                 return (result);
             }
-            void Remove(SessionImplementation* session, const string& keySystem, CDMi::IMediaKeySession* mediaKeySession)
+            Exchange::ISession* FindSession(const string& sessionId) const
             {
+                Exchange::ISession* result = nullptr;
 
-                _adminLock.Lock();
+                _indexLock.Lock();
+
+                std::unordered_map<string, SessionImplementation*>::const_iterator index(_sessionIds.find(sessionId));
+
+                if (index != _sessionIds.end()) {
+                    result = index->second;
+                    result->AddRef();
+                }
 
+                _indexLock.Unlock();
+
+                return (result);
+            }
+            void Remove(SessionImplementation* session, const string& keySystem, CDMi::IMediaKeySession* mediaKeySession)
+            {
                 ASSERT(session != nullptr);
 
+                // Out of the indexes before the CDM session is torn down, so it can not be found anymore and a
+                // key rotated in meanwhile is not indexed again.
+                _indexLock.Lock();
+
+                std::unordered_set<SessionImplementation*>::iterator index(_sessionList.find(session));
+
+                ASSERT(index != _sessionList.end());
+
+                if (index != _sessionList.end()) {
+                    _sessionList.erase(index);
+                    Unindex(session);
+                }
+
+                _indexLock.Unlock();
+
+                _adminLock.Lock();
+
                 if (mediaKeySession != nullptr) {
 
                     mediaKeySession->Run(nullptr);
@@ -1081,20 +1442,6 @@ POP_WARNING()
                     if (bufferid.empty() == false) {
                         _administrator.ReleaseBuffer(bufferid);
                     }
-
-                    std::list<SessionImplementation*>::iterator index(_sessionList.begin());
-
-                    while ((index != _sessionList.end()) && (session != (*index))) {
-                        index++;
-                    }
-
-                    ASSERT(index != _sessionList.end());
-
-                    if (index != _sessionList.end()) {
-                        const string sessionId(session->SessionId());
-                        // Before we remove it here, release it.
-                        _sessionList.erase(index);
-                    }
                 }
 
                 _adminLock.Unlock();
@@ -1108,7 +1455,11 @@ POP_WARNING()
             mutable Core::CriticalSection _adminLock;
             BufferAdministrator _administrator;
             uint32_t _defaultSize;
-            std::list<SessionImplementation*> _sessionList;
+            // Leaf lock, guards the sessions and their indexes. Nothing else is locked, nor is the CDM called, with it taken.
+            mutable Core::CriticalSection _indexLock;
+            std::unordered_set<SessionImplementation*> _sessionList;
+            std::unordered_map<string, SessionImplementation*> _sessionIds;
+            std::unordered_multimap<string, SessionImplementation*> _keyIds;
         };
 
         class Config : public Core::JSON::Container {
@@ -1162,6 +1513,7 @@ POP_WARNING()
                 , Connector(_T("/tmp/ocdm"))
                 , SharePath(_T("/tmp"))
                 , ShareSize(8 * 1024)
+                , ShareCount(64)
                 , KeySystems()
                 , Group()
             {
@@ -1169,6 +1521,7 @@ POP_WARNING()
                 Add(_T("connector"), &Connector);
                 Add(_T("sharepath"), &SharePath);
                 Add(_T("sharesize"), &ShareSize);
+                Add(_T("sharecount"), &ShareCount);
                 Add(_T("systems"), &KeySystems);
                 Add(_T("group"), &Group);
             }
@@ -1181,6 +1534,7 @@ POP_WARNING()
             Core::JSON::String Connector;
             Core::JSON::String SharePath;
             Core::JSON::DecUInt32 ShareSize;
+            Core::JSON::DecUInt16 ShareCount;
             Core::JSON::ArrayType<Systems> KeySystems;
             Core::JSON::String Group;
         };
@@ -1220,6 +1574,44 @@ POP_WARNING()
                 Core::WorkerPool::JobType<AsyncInitThread&> _worker;
             };
 
+            // Some vendor systems take hundreds of milliseconds to initialize, every library is loaded on a thread
+            // of its own so they do not hold back each other. These are not jobs on the worker pool, as that pool
+            // also serves the RPC calls that might be waiting for a key system to become available.
+            class SystemLoader : public Core::Thread {
+            public:
+                SystemLoader() = delete;
+                SystemLoader(const SystemLoader&) = delete;
+                SystemLoader& operator=(const SystemLoader&) = delete;
+
+                SystemLoader(OCDMImplementation& parent, const string& path)
+                    : Core::Thread(Core::Thread::DefaultStackSize(), _T("DRMSystemLoader"))
+                    , _parent(parent)
+                    , _path(path)
+                {
+                }
+                ~SystemLoader() override
+                {
+                    Core::Thread::Stop();
+                    Core::Thread::Wait(Core::Thread::STOPPED, Core::infinite);
+                }
+
+            private:
+                uint32_t Worker() override
+                {
+                    if (IsRunning() == true) {
+                        _parent.Load(_path);
+                    }
+
+                    Block();
+
+                    return (Core::infinite);
+                }
+
+            private:
+                OCDMImplementation& _parent;
+                const string _path;
+            };
+
     public:
         OCDMImplementation()
             : _entryPoint(nullptr)
@@ -1228,7 +1620,17 @@ POP_WARNING()
             , _shell(nullptr)
             , _compliant(false)
             , _systemToFactory()
+            , _systemBlacklistedCodecRegexps()
+            , _systemBlacklistedMediaTypeRegexps()
+            , _adminLock()
+            , _supportedTypes()
             , _systemLibraries()
+            , _keySystems()
+            , _configured()
+            , _designators()
+            , _loaders()
+            , _loading(0)
+            , _completed(false, true)
             , _thread(*this)
             , _group()
         {
@@ -1269,36 +1671,11 @@ POP_WARNING()
 
             const string locator(_shell->DataPath() + config.Location.Value());
 
-            // Before we start loading the mapping of the Keys to the factories, load the factories :-)
-            Core::Directory entry(locator.c_str(), _T("*.drm"));
-            std::map<const string, SystemFactory> factories;
-
-            while (entry.Next() == true) {
-                Core::Library library(entry.Current().c_str());
-
-                if (library.IsLoaded() == true) {
-                    GetDRMSystemFunction handle = reinterpret_cast<GetDRMSystemFunction>(library.LoadFunction(_T("GetSystemFactory")));
-
-                    if (handle != nullptr) {
-                        CDMi::ISystemFactory* entry = handle();
-
-                        if (handle != nullptr) {
-                            SystemFactory element;
-                            element.Name = Core::ClassNameOnly(entry->KeySystem()).Text();
-                            element.Factory = entry;
-                            _keySystems.push_back(element.Name);
-                            factories.insert(std::pair<const string, SystemFactory>(element.Name, element));
-                            _systemLibraries.push_back(library);
-                        }
-                    }
-                } else {
-                    SYSLOG(Logging::Startup, (_T("Could not load factory [%s], error [%s]"), Core::File::FileNameExtended(entry.Current()).c_str(), library.Error().c_str()));
-                    result = Core::ERROR_OPENING_FAILED;
-                }
-            }
-
+            // First take in what the configuration expects, requests for these designators wait for their library.
             Core::JSON::ArrayType<Config::Systems>::ConstIterator index(static_cast<const Config&>(config).KeySystems.Elements());
 
+            _adminLock.Lock();
+
             while (index.Next() == true) {
 
                 const string system(index.Current().Name.Value());
@@ -1306,27 +1683,17 @@ POP_WARNING()
                 if ((system.empty() == false) && (index.Current().Designators.IsSet() == true)) {
                     Core::JSON::ArrayType<Core::JSON::String>::ConstIterator designators(static_cast<const Core::JSON::ArrayType<Core::JSON::String>&>(index.Current().Designators).Elements());
 
-                    // Find a factory for the key system:
-                    std::map<const string, SystemFactory>::iterator factory(factories.find(system));
+                    SystemConfig& entry(_configured[system]);
 
                     while (designators.Next() == true) {
                         const string designator(designators.Current().Value());
                         if (designator.empty() == false) {
-                            if (factory != factories.end()) {
-                                _systemToFactory.insert(std::pair<const std::string, SystemFactory>(designator, factory->second));
-
-                            } else {
-                                SYSLOG(Logging::Startup, (_T("Required factory [%s], not found for [%s]"), system.c_str(), designator.c_str()));
-                                result = Core::ERROR_OPENING_FAILED;
-                            }
+                            entry.Designators.push_back(designator);
+                            _designators.insert(std::pair<const string, string>(designator, system));
                         }
                     }
 
-                    //now handle the configuration
-                    if (factory != factories.end()) {
-                        const string configuration(index.Current().Configuration.Value());
-                        factory->second.Factory->Initialize(_shell, configuration);
-                    }
+                    entry.Configuration = index.Current().Configuration.Value();
                 }
 
                 if ((system.empty() == false) && (index.Current().BlacklistedCodecRegexps.IsSet() == true)) {
@@ -1338,15 +1705,31 @@ POP_WARNING()
                 }
             }
 
-            if (_systemToFactory.size() == 0) {
-                SYSLOG(Logging::Startup, (_T("No DRM factories specified. OCDM can not service any DRM requests.")));
+            // Now load the factories, each key system is published as soon as its factory is initialized.
+            Core::Directory entry(locator.c_str(), _T("*.drm"));
+
+            while (entry.Next() == true) {
+                _loaders.emplace_back(*this, entry.Current());
+            }
+
+            _loading = static_cast<uint32_t>(_loaders.size());
+            _completed.ResetEvent();
+
+            if (_loading == 0) {
+                Completed();
+            }
+
+            _adminLock.Unlock();
+
+            for (SystemLoader& loader : _loaders) {
+                loader.Run();
             }
 
             if ((config.Group.IsSet() == true) && (config.Group.Value().empty() == false)){
                 _group = config.Group.Value();
             }
 
-            _entryPoint = Core::ServiceType<AccessorOCDM>::Create<Exchange::IAccessorOCDM>(this, config.SharePath.Value(), config.ShareSize.Value());
+            _entryPoint = Core::ServiceType<AccessorOCDM>::Create<Exchange::IAccessorOCDM>(this, config.SharePath.Value(), config.ShareSize.Value(), config.ShareCount.Value());
             ASSERT(_entryPoint != nullptr);
             _engine = Core::ProxyType<RPC::InvokeServer>::Create(&Core::IWorkerPool::Instance());
             ASSERT(_engine.IsValid() == true);
@@ -1369,9 +1752,6 @@ POP_WARNING()
                         ASSERT(subSystem->IsActive(PluginHost::ISubSystem::DECRYPTION) == false);
                         subSystem->Set(PluginHost::ISubSystem::DECRYPTION, this);
                     }
-                    if (_systemToFactory.size() == 0) {
-                        SYSLOG(Logging::Startup, (string(_T("OCDM server has NO key systems registered!!!"))));
-                    }
                 }
             }
 
@@ -1384,6 +1764,17 @@ POP_WARNING()
 
                 _thread.Stop();
 
+                // Wait for the libraries still loading, whoever waits for one of them can give up now.
+                _loaders.clear();
+
+                _adminLock.Lock();
+                _loading = 0;
+                for (std::pair<const string, SystemConfig>& entry : _configured) {
+                    entry.second.Loaded->SetEvent();
+                }
+                _completed.SetEvent();
+                _adminLock.Unlock();
+
                 std::map<const string, SystemFactory>::iterator factory(_systemToFactory.begin());
 
                 std::list<CDMi::ISystemFactory*> deinitialized;
@@ -1411,7 +1802,17 @@ POP_WARNING()
                 if (_engine.IsValid()) {
                     _engine.Release();
                 }
+                // A next configuration might offer different systems and blacklist different types.
+                _adminLock.Lock();
+                _systemToFactory.clear();
                 _systemLibraries.clear();
+                _keySystems.clear();
+                _configured.clear();
+                _designators.clear();
+                _systemBlacklistedCodecRegexps.clear();
+                _systemBlacklistedMediaTypeRegexps.clear();
+                _supportedTypes.clear();
+                _adminLock.Unlock();
 
                 _shell->Release();
                 _shell = nullptr;
@@ -1424,17 +1825,25 @@ POP_WARNING()
         }
         virtual RPC::IStringIterator* Systems() const override
         {
-            return (Core::ServiceType<RPC::StringIterator>::Create<RPC::IStringIterator>(_keySystems));
+            WaitForLoaders();
+
+            _adminLock.Lock();
+            std::list<string> keySystems(_keySystems);
+            _adminLock.Unlock();
+
+            return (Core::ServiceType<RPC::StringIterator>::Create<RPC::IStringIterator>(keySystems));
         }
         virtual RPC::IStringIterator* Designators(const string& keySystem) const override
         {
             std::list<string> designators;
+            WaitForLoaders();
             LoadDesignators(keySystem, designators);
             return (Core::ServiceType<RPC::StringIterator>::Create<RPC::IStringIterator>(designators));
         }
         virtual RPC::IStringIterator* Sessions(const string& keySystem) const override
         {
             std::list<string> sessions;
+            WaitForLoaders();
             LoadSessions(keySystem, sessions);
             return (Core::ServiceType<RPC::StringIterator>::Create<RPC::IStringIterator>(sessions));
         }
@@ -1459,42 +1868,31 @@ POP_WARNING()
             bool result = (keySystem.empty() == false);
 
             if (result == true) {
-                std::map<const std::string, SystemFactory>::iterator index(_systemToFactory.find(keySystem));
+                SystemFactory factory;
 
-                if (index == _systemToFactory.end()) {
+                if (Factory(keySystem, factory) == false) {
                     result = false;
                 } else {
                     if (contentType.empty() == false && _systemBlacklistedMediaTypeRegexps.empty() == false && _systemBlacklistedCodecRegexps.empty() == false) {
-                        std::string mimeType;
-                        std::vector<std::string> codecs;
-                        ParseContentType(contentType, mimeType, codecs);
-                        if (mimeType.empty() == false) {
-                            Blacklist::iterator systemMediaTypeRegexps = _systemBlacklistedMediaTypeRegexps.find(index->second.Name);
-                            if (systemMediaTypeRegexps != _systemBlacklistedMediaTypeRegexps.end()) {
-                                for (auto& systemMediaTypeRegexp : systemMediaTypeRegexps->second) {
-                                    if (std::regex_match(mimeType, std::regex(systemMediaTypeRegexp))) {
-                                        TRACE(Trace::Information, ("%s mime type matches blacklisted %s regexp", mimeType.c_str(), systemMediaTypeRegexp.c_str()));
-                                        result = false;
-                                        break;
-                                    }
-                                }
-                            }
+                        // Players ask the same question over and over again while starting up.
+                        const string key(keySystem + '\n' + contentType);
 
-                            if (result == true && codecs.size() > 0) {
-                                Blacklist::iterator systemCodecRegexps = _systemBlacklistedCodecRegexps.find(index->second.Name);
-                                if (systemCodecRegexps != _systemBlacklistedCodecRegexps.end()) {
-                                    for (const std::string& codec : codecs) {
-                                        for (const std::string& codecRegexp : systemCodecRegexps->second) {
-                                            if (std::regex_match(codec, std::regex(codecRegexp))) {
-                                                TRACE(Trace::Information, ("%s codec matches blacklisted %s regexp", codec.c_str(), codecRegexp.c_str()));
-                                                result = false;
-                                                break;
-                                            }
-                                        }
-                                    }
-                                }
+                        _adminLock.Lock();
+
+                        std::unordered_map<string, bool>::const_iterator cached(_supportedTypes.find(key));
+
+                        if (cached != _supportedTypes.end()) {
+                            result = cached->second;
+                        } else {
+                            result = IsAllowed(factory.Name, contentType);
+
+                            if (_supportedTypes.size() >= MaxSupportedTypes) {
+                                _supportedTypes.clear();
                             }
+                            _supportedTypes.emplace(key, result);
                         }
+
+                        _adminLock.Unlock();
                     }
                 }
             }
@@ -1509,10 +1907,10 @@ POP_WARNING()
             CDMi::IMediaKeys* result = nullptr;
 
             if (keySystem.empty() == false) {
-                std::map<const std::string, SystemFactory>::iterator index(_systemToFactory.find(keySystem));
+                SystemFactory factory;
 
-                if (_systemToFactory.end() != index) {
-                    result = index->second.Factory->Instance();
+                if (Factory(keySystem, factory) == true) {
+                    result = factory.Factory->Instance();
                 }
             }
 
@@ -1521,8 +1919,20 @@ POP_WARNING()
         }
 
     private:
+        // The lists of systems and designators are only complete once all libraries are done loading.
+        void WaitForLoaders() const
+        {
+            _adminLock.Lock();
+            const bool loading = (_loading != 0);
+            _adminLock.Unlock();
+
+            if ((loading == true) && (_completed.Lock(SystemLoadTimeout) != Core::ERROR_NONE)) {
+                TRACE(Trace::Error, (_T("Key systems are still loading, the list is incomplete")));
+            }
+        }
         void LoadDesignators(const string& keySystem, std::list<string>& designators) const
         {
+            _adminLock.Lock();
             std::map<const std::string, SystemFactory>::const_iterator index(_systemToFactory.begin());
             while (index != _systemToFactory.end()) {
                 if (keySystem == index->second.Name) {
@@ -1530,9 +1940,11 @@ POP_WARNING()
                 }
                 index++;
             }
+            _adminLock.Unlock();
         }
         void LoadSessions(const string& keySystem, std::list<string>& designators) const
         {
+            _adminLock.Lock();
             std::map<const std::string, SystemFactory>::const_iterator index(_systemToFactory.begin());
             while (index != _systemToFactory.end()) {
                 if (keySystem == index->second.Name) {
@@ -1540,6 +1952,117 @@ POP_WARNING()
                 }
                 index++;
             }
+            _adminLock.Unlock();
+        }
+        // If the library offering the key system is still loading, wait for that library only.
+        bool Factory(const std::string& keySystem, SystemFactory& factory)
+        {
+            bool result = false;
+
+            _adminLock.Lock();
+
+            std::map<const std::string, SystemFactory>::const_iterator index(_systemToFactory.find(keySystem));
+
+            if ((index == _systemToFactory.end()) && (_loading != 0)) {
+                std::map<const string, string>::const_iterator designator(_designators.find(keySystem));
+                std::map<const string, SystemConfig>::const_iterator configured(designator != _designators.end() ? _configured.find(designator->second) : _configured.end());
+
+                if (configured != _configured.end()) {
+                    Core::ProxyType<Core::Event> loaded(configured->second.Loaded);
+
+                    _adminLock.Unlock();
+
+                    if (loaded->Lock(SystemLoadTimeout) != Core::ERROR_NONE) {
+                        TRACE(Trace::Error, (_T("Key system %s is still not available"), keySystem.c_str()));
+                    }
+
+                    _adminLock.Lock();
+
+                    index = _systemToFactory.find(keySystem);
+                }
+            }
+
+            if (index != _systemToFactory.end()) {
+                factory = index->second;
+                result = true;
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+        void Load(const string& path)
+        {
+            Core::Library library(path.c_str());
+
+            if (library.IsLoaded() == true) {
+                GetDRMSystemFunction handle = reinterpret_cast<GetDRMSystemFunction>(library.LoadFunction(_T("GetSystemFactory")));
+                CDMi::ISystemFactory* entry = (handle != nullptr ? handle() : nullptr);
+
+                if (entry != nullptr) {
+                    SystemFactory element;
+                    element.Name = Core::ClassNameOnly(entry->KeySystem()).Text();
+                    element.Factory = entry;
+
+                    // The configuration is only changed while no libraries are loading.
+                    std::map<const string, SystemConfig>::iterator configured(_configured.find(element.Name));
+
+                    if (configured != _configured.end()) {
+                        element.Factory->Initialize(_shell, configured->second.Configuration);
+                    }
+
+                    _adminLock.Lock();
+
+                    _keySystems.push_back(element.Name);
+                    _systemLibraries.push_back(library);
+
+                    if (configured != _configured.end()) {
+                        for (const string& designator : configured->second.Designators) {
+                            // If more systems claim the same designator, the first one configured gets it.
+                            if (_designators[designator] == element.Name) {
+                                _systemToFactory.insert(std::pair<const std::string, SystemFactory>(designator, element));
+                            }
+                        }
+
+                        configured->second.Loaded->SetEvent();
+
+                        TRACE(Trace::Information, (_T("Key system %s is available"), element.Name.c_str()));
+                    }
+
+                    _adminLock.Unlock();
+                }
+            } else {
+                SYSLOG(Logging::Startup, (_T("Could not load factory [%s], error [%s]"), Core::File::FileNameExtended(path).c_str(), library.Error().c_str()));
+            }
+
+            _adminLock.Lock();
+
+            ASSERT(_loading != 0);
+
+            if ((_loading != 0) && (--_loading == 0)) {
+                Completed();
+            }
+
+            _adminLock.Unlock();
+        }
+        // All libraries are loaded, what is not available by now, will never be.
+        void Completed()
+        {
+            for (std::pair<const string, SystemConfig>& entry : _configured) {
+                for (const string& designator : entry.second.Designators) {
+                    if (_systemToFactory.find(designator) == _systemToFactory.end()) {
+                        SYSLOG(Logging::Startup, (_T("Required factory [%s], not found for [%s]"), entry.first.c_str(), designator.c_str()));
+                    }
+                }
+
+                entry.second.Loaded->SetEvent();
+            }
+
+            if (_systemToFactory.size() == 0) {
+                SYSLOG(Logging::Startup, (_T("No DRM factories specified. OCDM can not service any DRM requests.")));
+            }
+
+            _completed.SetEvent();
         }
     public:
         // -------------------------------------------------------------------------------------------------------------
@@ -1550,20 +2073,61 @@ POP_WARNING()
         END_INTERFACE_MAP
 
     private:
-        using Blacklist = std::map<const std::string, std::vector<std::string>>;
+        // All expressions of a key system are combined in a single one, compiled once when the configuration is read.
+        using Blacklist = std::map<const std::string, std::regex>;
+        static constexpr uint8_t MaxSupportedTypes = 64;
+        static constexpr uint32_t SystemLoadTimeout = 10000; // ms
+
         void FillBlacklist(Blacklist& blacklist, const std::string& system, const Core::JSON::ArrayType<Core::JSON::String>& list)
         {
             Core::JSON::ArrayType<Core::JSON::String>::ConstIterator iter(list.Elements());
 
-            std::vector<std::string> elements;
+            std::string combined;
             while (iter.Next() == true) {
                 const string element(iter.Current().Value());
                 if (element.empty() == false) {
-                    elements.emplace_back(std::move(element));
+                    combined += (combined.empty() == true ? _T("(?:") : _T("|(?:")) + element + _T(")");
                 }
             }
 
-            blacklist.insert(std::pair<const std::string, std::vector<std::string>>(system, elements));
+            if (combined.empty() == false) {
+                try {
+                    blacklist.insert(std::pair<const std::string, std::regex>(system, std::regex(combined, std::regex::ECMAScript | std::regex::optimize)));
+                } catch (const std::regex_error& error) {
+                    SYSLOG(Logging::Startup, (_T("Invalid blacklist expression for [%s]: %s"), system.c_str(), error.what()));
+                }
+            }
+        }
+        bool IsAllowed(const std::string& system, const std::string& contentType) const
+        {
+            bool result = true;
+            std::string mimeType;
+            std::vector<std::string> codecs;
+
+            ParseContentType(contentType, mimeType, codecs);
+
+            if (mimeType.empty() == false) {
+                Blacklist::const_iterator mediaTypes = _systemBlacklistedMediaTypeRegexps.find(system);
+                if ((mediaTypes != _systemBlacklistedMediaTypeRegexps.end()) && (std::regex_match(mimeType, mediaTypes->second) == true)) {
+                    TRACE(Trace::Information, ("%s mime type is blacklisted", mimeType.c_str()));
+                    result = false;
+                }
+
+                if ((result == true) && (codecs.size() > 0)) {
+                    Blacklist::const_iterator codecTypes = _systemBlacklistedCodecRegexps.find(system);
+                    if (codecTypes != _systemBlacklistedCodecRegexps.end()) {
+                        for (const std::string& codec : codecs) {
+                            if (std::regex_match(codec, codecTypes->second) == true) {
+                                TRACE(Trace::Information, ("%s codec is blacklisted", codec.c_str()));
+                                result = false;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+            return (result);
         }
 
         const Core::OptionalType<string>& Group() const {
@@ -1578,8 +2142,15 @@ POP_WARNING()
         std::map<const std::string, SystemFactory> _systemToFactory;
         Blacklist _systemBlacklistedCodecRegexps;
         Blacklist _systemBlacklistedMediaTypeRegexps;
+        mutable Core::CriticalSection _adminLock;
+        std::unordered_map<string, bool> _supportedTypes;
         std::list<Core::Library> _systemLibraries;
         std::list<string> _keySystems;
+        std::map<const string, SystemConfig> _configured;
+        std::map<const string, string> _designators;
+        std::list<SystemLoader> _loaders;
+        uint32_t _loading;
+        mutable Core::Event _completed;
         AsyncInitThread _thread;
         Core::OptionalType<string> _group;
     };
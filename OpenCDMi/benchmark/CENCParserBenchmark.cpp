@@ -0,0 +1,90 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures parsing the init data of a session, and matching it against the keys of another session, for the
+// common kinds of init data.
+//
+//     CENCParserBenchmark [iterations] [keys]
+
+#include "../CENCParser.h"
+#include "../fuzz/InitDataSamples.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Thunder;
+
+namespace {
+
+    template <typename RUN>
+    void Measure(const char name[], const uint32_t iterations, RUN&& run)
+    {
+        uint32_t found = 0;
+
+        const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+
+        for (uint32_t index = 0; index < iterations; index++) {
+            found += run();
+        }
+
+        const std::chrono::steady_clock::time_point stop(std::chrono::steady_clock::now());
+        const double nanoseconds = std::chrono::duration<double, std::nano>(stop - start).count();
+
+        printf("%-22s %9.1f ns/iteration (%u keys)\n", name, nanoseconds / iterations, found / iterations);
+    }
+
+    void Parse(const char name[], const uint32_t iterations, const Plugin::InitData::Buffer& data)
+    {
+        Measure(name, iterations, [&data]() -> uint32_t {
+            const Plugin::CommonEncryptionData parsed(data.data(), static_cast<uint16_t>(data.size()));
+            return (parsed.Keys().Count());
+        });
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const uint32_t iterations = (argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 100000);
+    const uint8_t count = (argc > 2 ? static_cast<uint8_t>(atoi(argv[2])) : 8);
+
+    std::vector<Plugin::InitData::Key> keys;
+    for (uint8_t index = 0; index < count; index++) {
+        keys.push_back(Plugin::InitData::MakeKey(index));
+    }
+
+    const Plugin::InitData::Buffer common(Plugin::InitData::PSSH(1, Plugin::InitData::CommonSystem, keys, Plugin::InitData::Buffer()));
+    const Plugin::InitData::Buffer playReady(Plugin::InitData::PSSH(0, Plugin::InitData::PlayReadySystem, keys, Plugin::InitData::PlayReadyObject(keys)));
+    const Plugin::InitData::Buffer widevine(Plugin::InitData::PSSH(0, Plugin::InitData::WidevineSystem, keys, Plugin::InitData::WidevineData(keys)));
+
+    Parse("parse pssh v1", iterations, common);
+    Parse("parse playready", iterations, playReady);
+    Parse("parse widevine", iterations, widevine);
+
+    // The last key of the session is the last one found.
+    const Plugin::InitData::Buffer last(Plugin::InitData::PSSH(1, Plugin::InitData::CommonSystem, { keys.back() }, Plugin::InitData::Buffer()));
+    const Plugin::CommonEncryptionData session(common.data(), static_cast<uint16_t>(common.size()));
+    const Plugin::CommonEncryptionData requested(last.data(), static_cast<uint16_t>(last.size()));
+
+    Measure("match session", iterations, [&]() -> uint32_t {
+        return (session.IsSupported(requested) == true ? static_cast<uint32_t>(requested.Keys().Count()) : 0);
+    });
+
+    return (0);
+}
@@ -0,0 +1,206 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares handing small samples one by one to the decrypting thread against handing them over in batches of
+// DecryptBatch.h. The RequestConsume/Consumed handshake of the session buffer is stood in for by a condition variable
+// between two threads, the decryption by an XOR over the sample. So only the cost of the hand over is measured, not
+// that of any DRM system.
+//
+//     DecryptBatchBenchmark [samples] [sample size] [batch size]
+
+#ifndef MODULE_NAME
+#define MODULE_NAME Benchmark_DecryptBatch
+#endif
+
+#include "../DecryptBatch.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+namespace {
+
+    using DecryptBatch = Thunder::Plugin::DecryptBatch;
+
+    class Handshake {
+    public:
+        Handshake(const Handshake&) = delete;
+        Handshake& operator=(const Handshake&) = delete;
+
+        Handshake()
+            : _lock()
+            , _signal()
+            , _size(0)
+            , _requested(false)
+            , _stopped(false)
+        {
+        }
+        ~Handshake() = default;
+
+    public:
+        // Producer side, returns once the consumer is done with the buffer.
+        void Request(const uint32_t size)
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+
+            _size = size;
+            _requested = true;
+            _signal.notify_all();
+            _signal.wait(lock, [this]() { return (_requested == false); });
+        }
+        void Stop()
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+
+            _stopped = true;
+            _signal.notify_all();
+        }
+        // Consumer side, returns false once stopped.
+        template <typename CONSUME>
+        bool Serve(CONSUME&& consume)
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+
+            _signal.wait(lock, [this]() { return ((_requested == true) || (_stopped == true)); });
+
+            if (_requested == true) {
+                const uint32_t size = _size;
+
+                lock.unlock();
+                consume(size);
+                lock.lock();
+
+                _requested = false;
+                _signal.notify_all();
+            }
+
+            return (_stopped == false);
+        }
+
+    private:
+        std::mutex _lock;
+        std::condition_variable _signal;
+        uint32_t _size;
+        bool _requested;
+        bool _stopped;
+    };
+
+    void Decrypt(uint8_t data[], const uint32_t length)
+    {
+        for (uint32_t index = 0; index < length; index++) {
+            data[index] ^= 0x5A;
+        }
+    }
+
+    uint32_t Fill(uint8_t buffer[], const uint16_t count, const uint32_t sampleSize)
+    {
+        const uint32_t table = sizeof(DecryptBatch::Header) + (count * sizeof(DecryptBatch::Sample));
+
+        DecryptBatch::Header header;
+        header.Magic = DecryptBatch::Magic;
+        header.Version = DecryptBatch::Version;
+        header.Count = count;
+        ::memcpy(buffer, &header, sizeof(header));
+
+        for (uint16_t index = 0; index < count; index++) {
+            DecryptBatch::Sample sample;
+            ::memset(&sample, 0, sizeof(sample));
+            sample.Offset = table + (index * sampleSize);
+            sample.Length = sampleSize;
+            ::memcpy(&(buffer[sizeof(DecryptBatch::Header) + (index * sizeof(DecryptBatch::Sample))]), &sample, sizeof(sample));
+            ::memset(&(buffer[sample.Offset]), index, sampleSize);
+        }
+
+        return (table + (count * sampleSize));
+    }
+
+    void Measure(const char name[], const uint32_t samples, const uint32_t sampleSize, const uint16_t batchSize)
+    {
+        std::vector<uint8_t> buffer(sizeof(DecryptBatch::Header) + (batchSize * (sizeof(DecryptBatch::Sample) + sampleSize)));
+        Handshake handshake;
+        uint32_t failed = 0;
+
+        std::thread consumer([&]() {
+            bool running = true;
+
+            while (running == true) {
+                running = handshake.Serve([&](const uint32_t size) {
+                    if (batchSize == 1) {
+                        Decrypt(buffer.data(), size);
+                    } else {
+                        DecryptBatch batch(buffer.data(), size);
+
+                        for (uint16_t index = 0; index < batch.Count(); index++) {
+                            DecryptBatch::Sample sample;
+
+                            if (batch.Get(index, sample) == true) {
+                                Decrypt(batch.Data(sample), sample.Length);
+                                sample.Status = 0;
+                            } else {
+                                sample.Status = 1;
+                                failed++;
+                            }
+
+                            batch.Set(index, sample);
+                        }
+                    }
+                });
+            }
+        });
+
+        const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+
+        for (uint32_t sent = 0; sent < samples; sent += batchSize) {
+            if (batchSize == 1) {
+                ::memset(buffer.data(), static_cast<uint8_t>(sent), sampleSize);
+                handshake.Request(sampleSize);
+            } else {
+                handshake.Request(Fill(buffer.data(), batchSize, sampleSize));
+            }
+        }
+
+        const std::chrono::steady_clock::time_point stop(std::chrono::steady_clock::now());
+
+        handshake.Stop();
+        consumer.join();
+
+        const double nanoseconds = std::chrono::duration<double, std::nano>(stop - start).count();
+
+        printf("%-7s %5u bytes, %3u per hand over: %9.1f ns/sample, %7.1f hand overs/1000 samples, %u failed\n",
+            name, sampleSize, batchSize, nanoseconds / samples, 1000.0 / batchSize, failed);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const uint32_t samples = (argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 100000);
+    const uint32_t sampleSize = (argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 512);
+    const uint16_t batchSize = (argc > 3 ? static_cast<uint16_t>(atoi(argv[3])) : 16);
+
+    Measure("single", samples, sampleSize, 1);
+    Measure("batched", samples, sampleSize, (batchSize > 1 ? batchSize : 2));
+
+    return (0);
+}
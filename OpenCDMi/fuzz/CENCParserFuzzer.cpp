@@ -0,0 +1,117 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Feeds init data to the CENC parser, as it would come from the media. Built with libFuzzer (clang), the fuzzer
+// drives it. Otherwise it runs the seeds, plus any files given, and random mutations of them under ASan/UBSan:
+//
+//     CENCParserFuzzer [iterations] [file...]
+//
+// The fuzz/corpus files are the seed corpus for both, the CENCParserFuzz target runs the fuzzer over them.
+
+#include "../CENCParser.h"
+#include "InitDataSamples.h"
+
+#include <cstdlib>
+
+#ifndef CENC_PARSER_LIBFUZZER
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#endif
+
+using namespace Thunder;
+
+namespace {
+
+    // Unlike ASSERT, also active in release builds, the fuzzer has to see the failure.
+    void Verify(const bool condition)
+    {
+        if (condition == false) {
+            ::abort();
+        }
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t data[], size_t size)
+{
+    if (size <= 0xFFFF) {
+        const Plugin::CommonEncryptionData parsed(data, static_cast<uint16_t>(size));
+        const Plugin::CommonEncryptionData copy(parsed);
+
+        Plugin::CommonEncryptionData::Iterator keys(parsed.Keys());
+        while (keys.Next() == true) {
+            Verify(copy.HasKeyId(keys.Current()) == true);
+        }
+
+        Verify(copy.IsSupported(parsed) == true);
+        Verify(copy.Status() == parsed.Status());
+    }
+
+    return (0);
+}
+
+#ifndef CENC_PARSER_LIBFUZZER
+
+int main(int argc, char* argv[])
+{
+    const uint32_t iterations = (argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 100000);
+    std::vector<Plugin::InitData::Buffer> seeds(Plugin::InitData::Seeds());
+    std::mt19937 generator(42);
+
+    // The files (e.g. the corpus) are parsed as is and mutated along with the built in seeds.
+    for (int index = 2; index < argc; index++) {
+        std::ifstream file(argv[index], std::ios::binary);
+        const Plugin::InitData::Buffer data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+        seeds.push_back(data);
+    }
+
+    for (uint32_t iteration = 0; iteration < iterations; iteration++) {
+        Plugin::InitData::Buffer data(seeds[iteration % seeds.size()]);
+        const uint32_t mutations = (generator() % 8);
+
+        for (uint32_t mutation = 0; (mutation < mutations) && (data.empty() == false); mutation++) {
+            const size_t position = (generator() % data.size());
+
+            switch (generator() % 4) {
+            case 0:
+                data[position] = static_cast<uint8_t>(generator());
+                break;
+            case 1:
+                data[position] ^= static_cast<uint8_t>(1 << (generator() % 8));
+                break;
+            case 2:
+                data.resize(position);
+                break;
+            default:
+                data.insert(data.begin() + position, static_cast<uint8_t>(generator()));
+                break;
+            }
+        }
+
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+    }
+
+    printf("%u inputs parsed\n", iterations + static_cast<uint32_t>(argc > 2 ? argc - 2 : 0));
+
+    return (0);
+}
+
+#endif
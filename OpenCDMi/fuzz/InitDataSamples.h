@@ -0,0 +1,160 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __OPENCDMI_INITDATASAMPLES_H
+#define __OPENCDMI_INITDATASAMPLES_H
+
+// Builds init data the way it is found in the media, as seeds for the fuzzer and input for the benchmark.
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Thunder {
+namespace Plugin {
+namespace InitData {
+
+    using Buffer = std::vector<uint8_t>;
+    using Key = std::array<uint8_t, 16>;
+
+    static const uint8_t CommonSystem[] = { 0x10, 0x77, 0xef, 0xec, 0xc0, 0xb2, 0x4d, 0x02, 0xac, 0xe3, 0x3c, 0x1e, 0x52, 0xe2, 0xfb, 0x4b };
+    static const uint8_t PlayReadySystem[] = { 0x9a, 0x04, 0xf0, 0x79, 0x98, 0x40, 0x42, 0x86, 0xab, 0x92, 0xe6, 0x5b, 0xe0, 0x88, 0x5f, 0x95 };
+    static const uint8_t WidevineSystem[] = { 0xed, 0xef, 0x8b, 0xa9, 0x79, 0xd6, 0x4a, 0xce, 0xa3, 0xc8, 0x27, 0xdc, 0xd5, 0x1d, 0x21, 0xed };
+
+    inline Key MakeKey(const uint8_t seed)
+    {
+        Key result;
+        for (uint8_t index = 0; index < result.size(); index++) {
+            result[index] = static_cast<uint8_t>((seed * 31) + index);
+        }
+        return (result);
+    }
+
+    inline void Append32BE(Buffer& buffer, const uint32_t value)
+    {
+        buffer.push_back(static_cast<uint8_t>(value >> 24));
+        buffer.push_back(static_cast<uint8_t>(value >> 16));
+        buffer.push_back(static_cast<uint8_t>(value >> 8));
+        buffer.push_back(static_cast<uint8_t>(value));
+    }
+
+    inline std::string Base64(const Key& key)
+    {
+        static const char Table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string result;
+
+        for (uint8_t index = 0; index < key.size(); index += 3) {
+            const uint32_t left = static_cast<uint32_t>(key.size() - index);
+            const uint32_t block = (key[index] << 16) | ((left > 1 ? key[index + 1] : 0) << 8) | (left > 2 ? key[index + 2] : 0);
+
+            result += Table[(block >> 18) & 0x3F];
+            result += Table[(block >> 12) & 0x3F];
+            result += (left > 1 ? Table[(block >> 6) & 0x3F] : '=');
+            result += (left > 2 ? Table[block & 0x3F] : '=');
+        }
+
+        return (result);
+    }
+
+    // Version 1 carries the key ids in the box, version 0 only in the system specific data.
+    inline Buffer PSSH(const uint8_t version, const uint8_t system[], const std::vector<Key>& keys, const Buffer& data)
+    {
+        Buffer result;
+        const uint32_t size = 8 + 4 + 16 + (version == 1 ? 4 + (16 * static_cast<uint32_t>(keys.size())) : 0) + 4 + static_cast<uint32_t>(data.size());
+
+        Append32BE(result, size);
+        result.insert(result.end(), { 'p', 's', 's', 'h' });
+        Append32BE(result, static_cast<uint32_t>(version) << 24);
+        result.insert(result.end(), system, system + 16);
+
+        if (version == 1) {
+            Append32BE(result, static_cast<uint32_t>(keys.size()));
+            for (const Key& key : keys) {
+                result.insert(result.end(), key.begin(), key.end());
+            }
+        }
+
+        Append32BE(result, static_cast<uint32_t>(data.size()));
+        result.insert(result.end(), data.begin(), data.end());
+
+        return (result);
+    }
+
+    // A PlayReady object with a single rights management record, holding a v4.2 header with all keys.
+    inline Buffer PlayReadyObject(const std::vector<Key>& keys)
+    {
+        std::string xml("<WRMHEADER xmlns=\"http://schemas.microsoft.com/DRM/2007/03/PlayReadyHeader\" version=\"4.2.0.0\"><DATA><PROTECTINFO><KIDS>");
+        for (const Key& key : keys) {
+            xml += "<KID ALGID=\"AESCTR\" CHECKSUM=\"xNvWVxoWk04=\" VALUE=\"" + Base64(key) + "\"></KID>";
+        }
+        xml += "</KIDS></PROTECTINFO></DATA></WRMHEADER>";
+
+        const uint32_t recordLength = static_cast<uint32_t>(xml.length() * 2);
+        const uint32_t size = 4 + 2 + 2 + 2 + recordLength;
+        Buffer result;
+
+        result.insert(result.end(), { static_cast<uint8_t>(size), static_cast<uint8_t>(size >> 8), static_cast<uint8_t>(size >> 16), static_cast<uint8_t>(size >> 24) });
+        result.insert(result.end(), { 1, 0, 1, 0, static_cast<uint8_t>(recordLength), static_cast<uint8_t>(recordLength >> 8) });
+
+        for (const char character : xml) {
+            result.push_back(static_cast<uint8_t>(character));
+            result.push_back(0);
+        }
+
+        return (result);
+    }
+
+    // Widevine system data, a protobuf with the key ids in field 2.
+    inline Buffer WidevineData(const std::vector<Key>& keys)
+    {
+        Buffer result;
+        for (const Key& key : keys) {
+            result.insert(result.end(), { 0x12, 0x10 });
+            result.insert(result.end(), key.begin(), key.end());
+        }
+        return (result);
+    }
+
+    inline std::vector<Buffer> Seeds()
+    {
+        const std::vector<Key> keys({ MakeKey(1), MakeKey(2), MakeKey(3) });
+        const Buffer playReady(PlayReadyObject(keys));
+        std::vector<Buffer> result;
+
+        result.push_back(PSSH(1, CommonSystem, keys, Buffer()));
+        result.push_back(PSSH(0, PlayReadySystem, keys, playReady));
+        result.push_back(PSSH(0, WidevineSystem, keys, WidevineData(keys)));
+        result.push_back(playReady);
+
+        Buffer both(result[0]);
+        both.insert(both.end(), result[1].begin(), result[1].end());
+        result.push_back(both);
+
+        const std::string json("{\"kids\":[\"" + Base64(keys[0]) + "\",\"" + Base64(keys[1]) + "\"]}");
+        result.push_back(Buffer(json.begin(), json.end()));
+
+        return (result);
+    }
+
+} // namespace InitData
+} // namespace Plugin
+} // namespace Thunder
+
+#endif // __OPENCDMI_INITDATASAMPLES_H
@@ -0,0 +1,469 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Module.h"
+#include "PerformanceMetrics.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef PERFORMANCEMETRICS_CHROMETRACE_FILE
+#define PERFORMANCEMETRICS_CHROMETRACE_FILE "/tmp/performancemetrics.json"
+#endif
+
+#ifndef PERFORMANCEMETRICS_CHROMETRACE_LIMIT
+#define PERFORMANCEMETRICS_CHROMETRACE_LIMIT 4096 // KB
+#endif
+
+namespace Thunder {
+namespace Plugin {
+
+namespace {
+
+    // The events of all observed plugins end up in one file in the Chrome Trace Event (JSON array) format, so a
+    // whole boot or app session can be opened in chrome://tracing or ui.perfetto.dev. The viewers accept an array
+    // without the closing bracket, so events are simply appended and the file is usable at any moment. Once half
+    // of the limit is reached the file is moved aside to <file>.1 and a new one is started, bounding the disk use.
+    class TraceFile {
+    public:
+        TraceFile(const TraceFile&) = delete;
+        TraceFile& operator=(const TraceFile&) = delete;
+
+        TraceFile()
+            : _adminLock()
+            , _fileName(_T(PERFORMANCEMETRICS_CHROMETRACE_FILE))
+            , _file(nullptr)
+            , _written(0)
+            , _limit(static_cast<uint64_t>(PERFORMANCEMETRICS_CHROMETRACE_LIMIT) * 1024 / 2)
+            , _pid(::getpid())
+            , _tracks()
+        {
+        }
+        ~TraceFile()
+        {
+            if (_file != nullptr) {
+                fclose(_file);
+            }
+        }
+
+        static TraceFile& Instance()
+        {
+            static TraceFile singleton;
+            return (singleton);
+        }
+
+    public:
+        // Timestamps are in us since boot, the clock the boot profile is expressed in as well.
+        static uint64_t Now()
+        {
+            struct timespec now;
+            clock_gettime(CLOCK_BOOTTIME, &now);
+            return ((static_cast<uint64_t>(now.tv_sec) * 1000000) + (now.tv_nsec / 1000));
+        }
+
+        // Every track shows up as a named thread in the viewer.
+        uint32_t Track(const string& name)
+        {
+            _adminLock.Lock();
+
+            uint32_t result = 0;
+
+            while ((result < _tracks.size()) && (_tracks[result] != name)) {
+                result++;
+            }
+
+            if (result == _tracks.size()) {
+                _tracks.push_back(name);
+
+                // A file that is (re)started lists all track names already, this one included.
+                if (Prepare() == false) {
+                    Append(_T("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":") + std::to_string(_pid) + _T(",\"tid\":") + std::to_string(result + 1) + _T(",\"args\":{\"name\":") + Quote(name) + _T("}}"));
+                }
+            }
+
+            _adminLock.Unlock();
+
+            return (result + 1);
+        }
+
+        void Complete(const uint32_t track, const string& name, const uint64_t timestamp, const uint64_t duration, const string& args = string())
+        {
+            Write(_T("{\"ph\":\"X\",\"name\":") + Quote(name) + Common(track, timestamp) + _T(",\"dur\":") + std::to_string(duration) + Arguments(args) + _T("}"));
+        }
+        void Instant(const uint32_t track, const string& name, const uint64_t timestamp, const string& args = string())
+        {
+            Write(_T("{\"ph\":\"i\",\"s\":\"t\",\"name\":") + Quote(name) + Common(track, timestamp) + Arguments(args) + _T("}"));
+        }
+        void Counter(const uint32_t track, const string& name, const uint64_t timestamp, const string& args)
+        {
+            Write(_T("{\"ph\":\"C\",\"name\":") + Quote(name) + Common(track, timestamp) + Arguments(args) + _T("}"));
+        }
+
+        static string Quote(const string& text)
+        {
+            string result(1, '"');
+
+            for (const TCHAR c : text) {
+                if ((c == '"') || (c == '\\')) {
+                    result += '\\';
+                    result += c;
+                } else if (static_cast<uint8_t>(c) < 0x20) {
+                    TCHAR escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<uint8_t>(c));
+                    result += escaped;
+                } else {
+                    result += c;
+                }
+            }
+
+            result += '"';
+            return (result);
+        }
+        static string Field(const TCHAR name[], const string& value)
+        {
+            return (Quote(name) + ':' + Quote(value));
+        }
+        template<typename NUMBER>
+        static string Field(const TCHAR name[], const NUMBER value)
+        {
+            return (Quote(name) + ':' + std::to_string(value));
+        }
+
+    private:
+        string Common(const uint32_t track, const uint64_t timestamp) const
+        {
+            return (_T(",\"pid\":") + std::to_string(_pid) + _T(",\"tid\":") + std::to_string(track) + _T(",\"ts\":") + std::to_string(timestamp));
+        }
+        static string Arguments(const string& args)
+        {
+            return (args.empty() == true ? string() : (_T(",\"args\":{") + args + _T("}")));
+        }
+        void Write(const string& event)
+        {
+            _adminLock.Lock();
+
+            Prepare();
+            Append(event);
+
+            _adminLock.Unlock();
+        }
+        // Called with the lock taken. Returns true if a new file was started.
+        bool Prepare()
+        {
+            bool started = false;
+
+            if ((_file != nullptr) && (_written >= _limit)) {
+                fclose(_file);
+                _file = nullptr;
+                ::rename(_fileName.c_str(), (_fileName + _T(".1")).c_str());
+            }
+
+            if (_file == nullptr) {
+                _file = fopen(_fileName.c_str(), "w");
+                _written = 0;
+
+                if (_file == nullptr) {
+                    TRACE(Trace::Error, (_T("Could not open %s for the performance trace"), _fileName.c_str()));
+                } else {
+                    started = true;
+                    _written = fprintf(_file, "[\n");
+
+                    // A new file needs the track names again, or the viewer shows bare numbers.
+                    for (uint32_t index = 0; index < _tracks.size(); index++) {
+                        _written += fprintf(_file, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":%s}},\n",
+                                            _pid, static_cast<uint32_t>(index + 1), Quote(_tracks[index]).c_str());
+                    }
+                }
+            }
+
+            return (started);
+        }
+        // Called with the lock taken.
+        void Append(const string& event)
+        {
+            if (_file != nullptr) {
+                const int written = fprintf(_file, "%s,\n", event.c_str());
+
+                if (written > 0) {
+                    _written += written;
+                }
+
+                fflush(_file);
+            }
+        }
+
+    private:
+        Core::CriticalSection _adminLock;
+        const string _fileName;
+        FILE* _file;
+        uint64_t _written;
+        const uint64_t _limit;
+        const uint32_t _pid;
+        std::vector<string> _tracks;
+    };
+
+}
+
+class ChromeTraceOutput : public PerformanceMetrics::IBrowserMetricsLogger {
+public:
+    ChromeTraceOutput(const ChromeTraceOutput&) = delete;
+    ChromeTraceOutput& operator=(const ChromeTraceOutput&) = delete;
+
+    ChromeTraceOutput()
+        : PerformanceMetrics::IBrowserMetricsLogger()
+        , _memory(nullptr)
+        , _lifetime(0)
+        , _loads(0)
+        , _activated(0)
+        , _suspended(0)
+    {
+    }
+    ~ChromeTraceOutput() override
+    {
+        ASSERT(_memory == nullptr);
+    }
+
+    void Enable(PluginHost::IShell& service, const string& callsign) override
+    {
+        ASSERT(_memory == nullptr);
+
+        _memory = service.QueryInterface<Exchange::IMemory>();
+        _lifetime = Output().Track(callsign);
+        _loads = Output().Track(callsign + _T(" page loads"));
+    }
+
+    void Disable() override
+    {
+        if (_memory != nullptr) {
+            _memory->Release();
+            _memory = nullptr;
+        }
+    }
+
+    void Activated() override
+    {
+        _activated = TraceFile::Now();
+        Output().Instant(_lifetime, _T("Activated"), _activated, Resident());
+    }
+
+    void Deactivated(const uint32_t uptime_s) override
+    {
+        const uint64_t now = TraceFile::Now();
+        const uint64_t start = (_activated != 0 ? _activated : (now - (static_cast<uint64_t>(uptime_s) * 1000000)));
+
+        Output().Complete(_lifetime, _T("Active"), start, now - start);
+        Output().Instant(_lifetime, _T("Deactivated"), now);
+
+        _activated = 0;
+    }
+
+    void Resumed() override
+    {
+        const uint64_t now = TraceFile::Now();
+
+        if (_suspended != 0) {
+            Output().Complete(_lifetime, _T("Suspended"), _suspended, now - _suspended);
+            _suspended = 0;
+        }
+        Output().Instant(_lifetime, _T("Resumed"), now, Resident());
+    }
+
+    void Suspended() override
+    {
+        _suspended = TraceFile::Now();
+        Output().Instant(_lifetime, _T("Suspended"), _suspended, Resident());
+    }
+
+    void Reclaimed(const PerformanceMetrics::SuspendReclaim& reclaim) override
+    {
+        string args(TraceFile::Field(_T("before"), reclaim.Before()));
+        args += ',' + TraceFile::Field(_T("after"), reclaim.After());
+        args += ',' + TraceFile::Field(_T("reclaimed"), reclaim.Reclaimed());
+        args += ',' + TraceFile::Field(_T("suspends"), reclaim.Suspends());
+        args += ',' + TraceFile::Field(_T("averagereclaimed"), reclaim.AverageReclaimed());
+
+        Output().Instant(_lifetime, _T("Memory settled"), TraceFile::Now(), args);
+    }
+
+    void LoadFinished(const string& URL, const int32_t httpstatus, const bool success, const uint32_t totalsuccess, const uint32_t totalfailed) override
+    {
+        string args(TraceFile::Field(_T("url"), URL));
+        args += ',' + TraceFile::Field(_T("status"), httpstatus);
+        args += ',' + TraceFile::Field(_T("success"), (success == true ? 1 : 0));
+        args += ',' + TraceFile::Field(_T("totalsuccess"), totalsuccess);
+        args += ',' + TraceFile::Field(_T("totalfailed"), totalfailed);
+
+        const string rss(Resident());
+        if (rss.empty() == false) {
+            args += ',' + rss;
+        }
+
+        Output().Instant(_loads, _T("Load finished"), TraceFile::Now(), args);
+    }
+
+    void URLChange(const string& URL, const bool loaded) override
+    {
+        Output().Instant(_loads, (loaded == true ? _T("URL loaded") : _T("URL change")), TraceFile::Now(), TraceFile::Field(_T("url"), URL));
+    }
+
+    void VisibilityChange(const bool hidden) override
+    {
+        Output().Instant(_lifetime, (hidden == true ? _T("Hidden") : _T("Visible")), TraceFile::Now());
+    }
+
+    void PageClosure() override
+    {
+        Output().Instant(_loads, _T("Page closure"), TraceFile::Now());
+    }
+
+    void LoadTimeline(const PerformanceMetrics::PageLoadTimeline& timeline) override
+    {
+        using Timeline = PerformanceMetrics::PageLoadTimeline;
+
+        // Reported right after the load finished, the phases are relative to the URL change.
+        const uint64_t finished = static_cast<uint64_t>(timeline.Phase(Timeline::FINISHED)) * 1000;
+        const uint64_t now = TraceFile::Now();
+        const uint64_t start = (now > finished ? now - finished : 0);
+
+        string args(TraceFile::Field(_T("url"), timeline.URL()));
+        args += ',' + TraceFile::Field(_T("success"), (timeline.Success() == true ? 1 : 0));
+
+        for (uint8_t index = 0; index < Timeline::PHASES; index++) {
+            const Timeline::phase which = static_cast<Timeline::phase>(index);
+            args += ',' + TraceFile::Field(Timeline::Name(which), timeline.Phase(which));
+        }
+
+        Output().Complete(_loads, timeline.Origin(), start, finished, args);
+
+        for (const Timeline::phase which : { Timeline::COMMITTED, Timeline::VISIBLE }) {
+            if (timeline.Phase(which) != 0) {
+                Output().Instant(_loads, Timeline::Name(which), start + (static_cast<uint64_t>(timeline.Phase(which)) * 1000));
+            }
+        }
+    }
+
+    void LoadResources(const PerformanceMetrics::PageLoadSampler& sampler) override
+    {
+        if (sampler.Samples() > 0) {
+            static const long ticks = sysconf(_SC_CLK_TCK);
+
+            const uint64_t now = TraceFile::Now();
+            const uint64_t duration = static_cast<uint64_t>(sampler.Last().Time) * 1000;
+            const uint64_t start = (now > duration ? now - duration : 0);
+
+            for (uint32_t index = 0; index < sampler.Samples(); index++) {
+                const PerformanceMetrics::PageLoadSampler::Sample& sample(sampler[index]);
+                string args(TraceFile::Field(_T("rss_kb"), sample.Resident / 1024));
+
+                if ((index > 0) && (ticks > 0)) {
+                    const PerformanceMetrics::PageLoadSampler::Sample& previous(sampler[index - 1]);
+                    const uint32_t elapsed = sample.Time - previous.Time;
+
+                    // Processes that went away take their ticks with them, the sum is not guaranteed to grow.
+                    const uint64_t used = (sample.CPU > previous.CPU ? sample.CPU - previous.CPU : 0);
+
+                    if (elapsed != 0) {
+                        args += ',' + TraceFile::Field(_T("cpu_percent"), (used * 1000 * 100) / ticks / elapsed);
+                    }
+                }
+
+                Output().Counter(_loads, _T("Browser resources"), start + (static_cast<uint64_t>(sample.Time) * 1000), args);
+            }
+        }
+    }
+
+    void FrameRate(const PerformanceMetrics::FrameRateSampler& sampler) override
+    {
+        const uint64_t now = TraceFile::Now();
+        const uint64_t duration = static_cast<uint64_t>(sampler.Seconds()) * 1000000;
+
+        string args(TraceFile::Field(_T("url"), sampler.URL()));
+        args += ',' + TraceFile::Field(_T("average"), sampler.Average());
+        args += ',' + TraceFile::Field(_T("minimum"), sampler.Minimum());
+        args += ',' + TraceFile::Field(_T("dropped"), sampler.Dropped());
+        args += ',' + TraceFile::Field(_T("janky"), sampler.Janky());
+
+        Output().Complete(_lifetime, _T("Rendering"), (now > duration ? now - duration : 0), duration, args);
+    }
+
+private:
+    static TraceFile& Output()
+    {
+        return (TraceFile::Instance());
+    }
+    string Resident() const
+    {
+        return (_memory != nullptr ? TraceFile::Field(_T("rss"), _memory->Resident()) : string());
+    }
+
+private:
+    Exchange::IMemory* _memory;
+    uint32_t _lifetime;
+    uint32_t _loads;
+    uint64_t _activated;
+    uint64_t _suspended;
+};
+
+class ChromeTraceBootOutput : public PerformanceMetrics::IBootMetricsLogger {
+public:
+    ChromeTraceBootOutput(const ChromeTraceBootOutput&) = delete;
+    ChromeTraceBootOutput& operator=(const ChromeTraceBootOutput&) = delete;
+
+    ChromeTraceBootOutput() = default;
+    ~ChromeTraceBootOutput() override = default;
+
+    void CriticalPath(const PerformanceMetrics::BootProfile& profile) override
+    {
+        TraceFile& output(TraceFile::Instance());
+        const uint32_t track = output.Track(_T("Boot"));
+        const uint64_t base = static_cast<uint64_t>(profile.ProcessStart) * 1000;
+
+        output.Complete(track, _T("Boot up to ") + profile.Target, base, static_cast<uint64_t>(profile.Ready) * 1000);
+
+        for (const PerformanceMetrics::BootProfile::Step& step : profile.Path) {
+            output.Complete(track, step.Callsign, base + (static_cast<uint64_t>(step.Start) * 1000), static_cast<uint64_t>(step.End - step.Start) * 1000);
+
+            if (step.Spawned != 0) {
+                output.Instant(track, step.Callsign + _T(" spawned"), base + (static_cast<uint64_t>(step.Spawned) * 1000));
+            }
+        }
+
+        for (const PerformanceMetrics::BootProfile::Milestone& milestone : profile.Milestones) {
+            output.Instant(track, milestone.Name, base + (static_cast<uint64_t>(milestone.Time) * 1000));
+        }
+    }
+};
+
+template<class LOGGERINTERFACE>
+std::unique_ptr<LOGGERINTERFACE> PerformanceMetrics::LoggerFactory() {
+    return std::unique_ptr<LOGGERINTERFACE>(new ChromeTraceOutput());
+}
+
+template<>
+std::unique_ptr<PerformanceMetrics::IBootMetricsLogger> PerformanceMetrics::LoggerFactory<PerformanceMetrics::IBootMetricsLogger>() {
+    return std::unique_ptr<PerformanceMetrics::IBootMetricsLogger>(new ChromeTraceBootOutput());
+}
+
+template std::unique_ptr<PerformanceMetrics::IBasicMetricsLogger> PerformanceMetrics::LoggerFactory<PerformanceMetrics::IBasicMetricsLogger>();
+template std::unique_ptr<PerformanceMetrics::IStateMetricsLogger> PerformanceMetrics::LoggerFactory<PerformanceMetrics::IStateMetricsLogger>();
+template std::unique_ptr<PerformanceMetrics::IBrowserMetricsLogger> PerformanceMetrics::LoggerFactory<PerformanceMetrics::IBrowserMetricsLogger>();
+
+}
+}
@@ -0,0 +1,458 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// A registry of counters, gauges and histograms in shared memory. A plugin (in or out of process) opens a
+// registry under its own name and registers its metrics once; publishing a value is then a single relaxed
+// atomic operation on a shard owned by the calling thread, no locks and no RPC. PerformanceMetrics maps all
+// registries read-only and sums the shards when it is asked for the values.
+//
+// Header only and without dependencies beyond the standard library, POSIX and the platform defines of the Thunder
+// core (__POSIX__, __WINDOWS__), so anything can publish:
+//
+//     Thunder::Metrics::Registry registry;
+//     registry.Open("MyPlugin");
+//     Thunder::Metrics::Counter requests(registry.AddCounter("requests"));
+//     ...
+//     requests.Increment();
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <string.h>
+
+#if !defined(__POSIX__) && !defined(__WINDOWS__)
+#error "Include the Thunder core before the metrics registry"
+#endif
+
+#ifdef __POSIX__
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef METRICS_REGISTRY_PATH
+#define METRICS_REGISTRY_PATH "/dev/shm/"
+#endif
+
+namespace Thunder {
+namespace Metrics {
+
+    enum class type : uint8_t {
+        NONE,
+        COUNTER, // only goes up, summed over all shards
+        GAUGE, // set to a value, not sharded
+        HISTOGRAM // power of two buckets and a sum, summed over all shards
+    };
+
+    static constexpr uint32_t Magic = 0x4D545243;
+    static constexpr uint16_t Version = 1;
+    static constexpr uint8_t MaxMetrics = 64;
+    static constexpr uint8_t MaxShards = 16;
+    static constexpr uint16_t MaxSlots = 512; // values per shard
+    static constexpr uint8_t HistogramBuckets = 32; // [0], [1], [2, 4), [4, 8), ... [2^30, ...)
+    static constexpr uint8_t NameLength = 55;
+    static constexpr const char* Prefix = "thunder.metrics.";
+
+    // Values in shared memory must be lock free atomics. Where 64 bit ones are not (some 32 bit platforms), the
+    // values are 32 bit and wrap. A reader only accepts registries written with the same width.
+    using value_type = std::conditional<ATOMIC_LLONG_LOCK_FREE == 2, uint64_t, uint32_t>::type;
+
+    static_assert(ATOMIC_INT_LOCK_FREE == 2, "Metrics in shared memory need lock free atomics");
+
+    struct Descriptor {
+        std::atomic<uint8_t> Ready; // set once the rest is filled in
+        type Type;
+        uint16_t Slot; // first value in every shard
+        uint32_t Reserved;
+        char Name[NameLength + 1];
+    };
+
+    struct alignas(64) Shard {
+        std::atomic<value_type> Values[MaxSlots];
+    };
+
+    struct Layout {
+        std::atomic<uint32_t> Magic;
+        uint16_t Version;
+        uint16_t Width; // bytes per value
+        std::atomic<uint32_t> Metrics; // descriptors handed out
+        std::atomic<uint32_t> Slots; // values handed out, in every shard
+        Descriptor Descriptors[MaxMetrics];
+        Shard Shards[MaxShards];
+    };
+
+    // Every thread of a process gets its own shard (or shares one, beyond MaxShards threads), so threads that
+    // publish the same metric do not fight over the same cache line.
+    inline uint8_t ShardIndex()
+    {
+        static std::atomic<uint32_t> threads(0);
+        static thread_local const uint8_t index = static_cast<uint8_t>(threads.fetch_add(1, std::memory_order_relaxed) % MaxShards);
+        return (index);
+    }
+
+    inline uint8_t HistogramBucket(uint64_t value)
+    {
+        uint8_t result = 0;
+        while ((value != 0) && (result < (HistogramBuckets - 1))) {
+            value >>= 1;
+            result++;
+        }
+        return (result);
+    }
+
+    class Counter {
+    public:
+        Counter()
+            : _layout(nullptr)
+            , _slot(0)
+        {
+        }
+        Counter(Layout* layout, const uint16_t slot)
+            : _layout(layout)
+            , _slot(slot)
+        {
+        }
+        Counter(const Counter&) = default;
+        Counter& operator=(const Counter&) = default;
+        ~Counter() = default;
+
+        bool IsValid() const
+        {
+            return (_layout != nullptr);
+        }
+        void Increment(const uint64_t value = 1)
+        {
+            if (_layout != nullptr) {
+                _layout->Shards[ShardIndex()].Values[_slot].fetch_add(static_cast<value_type>(value), std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        Layout* _layout;
+        uint16_t _slot;
+    };
+
+    class Gauge {
+    public:
+        Gauge()
+            : _layout(nullptr)
+            , _slot(0)
+        {
+        }
+        Gauge(Layout* layout, const uint16_t slot)
+            : _layout(layout)
+            , _slot(slot)
+        {
+        }
+        Gauge(const Gauge&) = default;
+        Gauge& operator=(const Gauge&) = default;
+        ~Gauge() = default;
+
+        bool IsValid() const
+        {
+            return (_layout != nullptr);
+        }
+        void Set(const uint64_t value)
+        {
+            if (_layout != nullptr) {
+                _layout->Shards[0].Values[_slot].store(static_cast<value_type>(value), std::memory_order_relaxed);
+            }
+        }
+        void Add(const int64_t delta)
+        {
+            if (_layout != nullptr) {
+                _layout->Shards[0].Values[_slot].fetch_add(static_cast<value_type>(delta), std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        Layout* _layout;
+        uint16_t _slot;
+    };
+
+    class Histogram {
+    public:
+        Histogram()
+            : _layout(nullptr)
+            , _slot(0)
+        {
+        }
+        Histogram(Layout* layout, const uint16_t slot)
+            : _layout(layout)
+            , _slot(slot)
+        {
+        }
+        Histogram(const Histogram&) = default;
+        Histogram& operator=(const Histogram&) = default;
+        ~Histogram() = default;
+
+        bool IsValid() const
+        {
+            return (_layout != nullptr);
+        }
+        void Record(const uint64_t value)
+        {
+            if (_layout != nullptr) {
+                std::atomic<value_type>* values = &(_layout->Shards[ShardIndex()].Values[_slot]);
+                values[HistogramBucket(value)].fetch_add(1, std::memory_order_relaxed);
+                values[HistogramBuckets].fetch_add(static_cast<value_type>(value), std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        Layout* _layout;
+        uint16_t _slot;
+    };
+
+    // What a reader gets for one metric, the shards summed up.
+    struct Value {
+        std::string Name;
+        type Type;
+        uint64_t Total; // counter and gauge value, number of recorded values of a histogram
+        uint64_t Sum; // of the recorded values of a histogram
+        std::array<uint64_t, HistogramBuckets> Buckets;
+    };
+
+    class Registry {
+    public:
+        Registry(const Registry&) = delete;
+        Registry& operator=(const Registry&) = delete;
+
+        Registry()
+            : _layout(nullptr)
+            , _writable(false)
+        {
+        }
+        ~Registry()
+        {
+            Close();
+        }
+
+    public:
+        // Creates the registry if it does not exist yet, reopening it continues with the values in it.
+        bool Open(const std::string& name)
+        {
+            return (Map(name, true));
+        }
+        // For readers only.
+        bool Attach(const std::string& name)
+        {
+            return (Map(name, false));
+        }
+        void Close()
+        {
+            if (_layout != nullptr) {
+#ifdef __POSIX__
+                ::munmap(_layout, sizeof(Layout));
+#endif
+                _layout = nullptr;
+            }
+        }
+        bool IsOpen() const
+        {
+            return (_layout != nullptr);
+        }
+
+        // An invalid handle, that ignores whatever is published to it, if the registry is full.
+        Counter AddCounter(const std::string& name)
+        {
+            Layout* layout = _layout;
+            const uint16_t slot = Register(name, type::COUNTER, 1);
+            return (slot != static_cast<uint16_t>(~0) ? Counter(layout, slot) : Counter());
+        }
+        Gauge AddGauge(const std::string& name)
+        {
+            Layout* layout = _layout;
+            const uint16_t slot = Register(name, type::GAUGE, 1);
+            return (slot != static_cast<uint16_t>(~0) ? Gauge(layout, slot) : Gauge());
+        }
+        Histogram AddHistogram(const std::string& name)
+        {
+            Layout* layout = _layout;
+            const uint16_t slot = Register(name, type::HISTOGRAM, HistogramBuckets + 1);
+            return (slot != static_cast<uint16_t>(~0) ? Histogram(layout, slot) : Histogram());
+        }
+
+        void Values(std::vector<Value>& values) const
+        {
+            if (_layout != nullptr) {
+                const uint32_t count = std::min(_layout->Metrics.load(std::memory_order_acquire), static_cast<uint32_t>(MaxMetrics));
+
+                for (uint32_t index = 0; index < count; index++) {
+                    const Descriptor& descriptor(_layout->Descriptors[index]);
+
+                    if (descriptor.Ready.load(std::memory_order_acquire) != 0) {
+                        Value value;
+                        value.Name = std::string(descriptor.Name, ::strnlen(descriptor.Name, NameLength));
+                        value.Type = descriptor.Type;
+                        value.Total = 0;
+                        value.Sum = 0;
+                        value.Buckets.fill(0);
+
+                        if (descriptor.Type == type::GAUGE) {
+                            value.Total = _layout->Shards[0].Values[descriptor.Slot].load(std::memory_order_relaxed);
+                        } else {
+                            for (uint8_t shard = 0; shard < MaxShards; shard++) {
+                                const std::atomic<value_type>* slots = &(_layout->Shards[shard].Values[descriptor.Slot]);
+
+                                if (descriptor.Type == type::COUNTER) {
+                                    value.Total += slots[0].load(std::memory_order_relaxed);
+                                } else {
+                                    for (uint8_t bucket = 0; bucket < HistogramBuckets; bucket++) {
+                                        const uint64_t hits = slots[bucket].load(std::memory_order_relaxed);
+                                        value.Buckets[bucket] += hits;
+                                        value.Total += hits;
+                                    }
+                                    value.Sum += slots[HistogramBuckets].load(std::memory_order_relaxed);
+                                }
+                            }
+                        }
+
+                        values.push_back(std::move(value));
+                    }
+                }
+            }
+        }
+
+        // Names of all registries that were ever opened (and not cleaned up since boot).
+        static void Registries(std::vector<std::string>& names)
+        {
+#ifdef __POSIX__
+            DIR* directory = ::opendir(METRICS_REGISTRY_PATH);
+
+            if (directory != nullptr) {
+                const size_t length = ::strlen(Prefix);
+                struct dirent* entry;
+
+                while ((entry = ::readdir(directory)) != nullptr) {
+                    if (::strncmp(entry->d_name, Prefix, length) == 0) {
+                        names.emplace_back(&(entry->d_name[length]));
+                    }
+                }
+
+                ::closedir(directory);
+            }
+#else
+            (void)names;
+#endif
+        }
+
+    private:
+        bool Map(const std::string& name, const bool writable)
+        {
+            Close();
+
+#ifdef __POSIX__
+            const std::string fileName(std::string(METRICS_REGISTRY_PATH) + Prefix + name);
+            const int fd = ::open(fileName.c_str(), (writable == true ? (O_RDWR | O_CREAT) : O_RDONLY) | O_CLOEXEC, 0660);
+
+            if (fd >= 0) {
+                struct stat info;
+
+                // Growing a new file gives zeroed pages, a valid empty registry apart from the magic.
+                if (((writable == true) && (::ftruncate(fd, sizeof(Layout)) != 0)) || (::fstat(fd, &info) != 0)) {
+                    info.st_size = 0;
+                }
+
+                if (static_cast<size_t>(info.st_size) >= sizeof(Layout)) {
+                    void* memory = ::mmap(nullptr, sizeof(Layout), (writable == true ? (PROT_READ | PROT_WRITE) : PROT_READ), MAP_SHARED, fd, 0);
+
+                    if (memory != MAP_FAILED) {
+                        _layout = static_cast<Layout*>(memory);
+                        _writable = writable;
+
+                        if ((writable == true) && (_layout->Magic.load() == 0)) {
+                            // Racing writers all store the same version, only then is the registry marked valid.
+                            _layout->Version = Version;
+                            _layout->Width = sizeof(value_type);
+                            uint32_t expected = 0;
+                            _layout->Magic.compare_exchange_strong(expected, Magic);
+                        }
+
+                        if ((_layout->Magic.load() != Magic) || (_layout->Version != Version) || (_layout->Width != sizeof(value_type))) {
+                            Close();
+                        }
+                    }
+                }
+
+                ::close(fd);
+            }
+#else
+            (void)name;
+            (void)writable;
+#endif
+
+            return (_layout != nullptr);
+        }
+
+        // Returns the slot of the metric, or ~0 if it does not fit anymore. A metric that is already there (the
+        // publisher restarted) is continued. Two publishers registering the same name at the very same moment
+        // might both get a new one, the reader then reports it twice.
+        uint16_t Register(const std::string& name, const type kind, const uint16_t width)
+        {
+            uint16_t result = static_cast<uint16_t>(~0);
+
+            if ((_layout != nullptr) && (_writable == true) && (name.empty() == false)) {
+                const uint32_t count = std::min(_layout->Metrics.load(std::memory_order_acquire), static_cast<uint32_t>(MaxMetrics));
+
+                for (uint32_t index = 0; (index < count) && (result == static_cast<uint16_t>(~0)); index++) {
+                    const Descriptor& descriptor(_layout->Descriptors[index]);
+
+                    if ((descriptor.Ready.load(std::memory_order_acquire) != 0) && (descriptor.Type == kind) && (name.compare(0, NameLength, descriptor.Name) == 0)) {
+                        result = descriptor.Slot;
+                    }
+                }
+
+                if (result == static_cast<uint16_t>(~0)) {
+                    const uint32_t slot = _layout->Slots.fetch_add(width);
+                    const uint32_t index = _layout->Metrics.fetch_add(1);
+
+                    if (((slot + width) <= MaxSlots) && (index < MaxMetrics)) {
+                        Descriptor& descriptor(_layout->Descriptors[index]);
+
+                        ::strncpy(descriptor.Name, name.c_str(), NameLength);
+                        descriptor.Name[NameLength] = '\0';
+                        descriptor.Type = kind;
+                        descriptor.Slot = static_cast<uint16_t>(slot);
+                        descriptor.Ready.store(1, std::memory_order_release);
+
+                        result = static_cast<uint16_t>(slot);
+                    }
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        Layout* _layout;
+        bool _writable;
+    };
+
+} // namespace Metrics
+} // namespace Thunder
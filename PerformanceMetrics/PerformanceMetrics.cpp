@@ -34,6 +34,21 @@ namespace Plugin {
             // Controls
             {} 
         );
+
+        void Collect(const Core::JSON::String& single, Core::JSON::ArrayType<Core::JSON::String>& list, std::vector<string>& patterns)
+        {
+            if ((single.IsSet() == true) && (single.Value().empty() == false)) {
+                patterns.push_back(single.Value());
+            }
+
+            Core::JSON::ArrayType<Core::JSON::String>::Iterator index(list.Elements());
+
+            while (index.Next() == true) {
+                if (index.Current().Value().empty() == false) {
+                    patterns.push_back(index.Current().Value());
+                }
+            }
+        }
     }
 
     const string PerformanceMetrics::Initialize(PluginHost::IShell* service)
@@ -45,22 +60,49 @@ namespace Plugin {
 
         string result;
 
-        if ((config.ObservableCallsign.IsSet() == true) && (config.ObservableClassname.IsSet() == true)) {
-            result = _T("Both callsign and classname set to observe for metrics");
+        const SamplerSettings sampling{ config.Sampling.Interval.Value(), config.Sampling.Capacity.Value(), config.Sampling.Settle.Value(), config.Sampling.FrameRate.Value() };
+
+        PatternPerfMetricsHandler::Patterns callsigns;
+        PatternPerfMetricsHandler::Patterns classnames;
+
+        Collect(config.ObservableCallsign, config.ObservableCallsigns, callsigns);
+        Collect(config.ObservableClassname, config.ObservableClassnames, classnames);
+
+        BenchmarkSettings benchmark{ {}, config.Benchmark.Iterations.Value(), config.Benchmark.Delay.Value(), config.Benchmark.Pause.Value(), config.Benchmark.Timeout.Value(), config.Benchmark.Report.Value() };
+        Collect(Core::JSON::String(), config.Benchmark.URLs, benchmark.URLs);
+
+        if ((config.UIReady.IsSet() == true) && ((callsigns.empty() == false) || (classnames.empty() == false))) {
+            result = _T("Boot profiling can not be combined with observing a callsign or classname");
+        }
+        else if ((config.UIReady.IsSet() == true) && (config.UIReady.Value().empty() == false)) {
+            _handler.reset(new BootPerfMetricsHandler(*service, config.UIReady.Value()));
+        }
+        else if ((callsigns.size() == 1) && (classnames.empty() == true) && (callsigns.front().find_first_of(_T("*?[")) == string::npos)) {
+            // A single plugin, no need to match every activation against patterns.
+            if (benchmark.Report.empty() == true) {
+                benchmark.Report = service->VolatilePath() + _T("benchmark-") + callsigns.front() + _T(".json");
+            }
+            _handler.reset(new CallsignPerfMetricsHandler(callsigns.front(), _statistics, sampling, benchmark));
         }
-        else if ((config.ObservableCallsign.IsSet() == true) && ( config.ObservableCallsign.Value().empty() == false)) {
-            _handler.reset(new CallsignPerfMetricsHandler(config.ObservableCallsign.Value()));
+        else if (benchmark.URLs.empty() == false) {
+            result = _T("A load benchmark can only drive a single callsign");
         }
-        else if ((config.ObservableClassname.IsSet() == true) && ( config.ObservableClassname.Value().empty() == false)) {
-            _handler.reset(new ClassnamePerfMetricsHandler(config.ObservableClassname.Value()));
+        else if ((callsigns.empty() == false) || (classnames.empty() == false)) {
+            _handler.reset(new PatternPerfMetricsHandler(callsigns, classnames, _statistics, sampling));
         } else {
-            result = _T("No callsign or classname set to observe for metrics");
+            result = _T("No callsign, classname or uiready set to observe for metrics");
         }
 
         if (result.empty() == true) {
             ASSERT(_handler);
+
+            Core::Directory(service->PersistentPath().c_str()).CreatePath();
+            _statistics.Open(service->PersistentPath() + _T("launches.dat"));
+            RegisterAll();
+
             _handler->Initialize();
             service->Register(&_notification);
+            _handler->Registered();
         }
 
         return result;
@@ -75,6 +117,9 @@ namespace Plugin {
             // if the deactivate of the observable did not happen we must clean up here
             _handler->Deinitialize();
             _handler.reset();
+
+            UnregisterAll();
+            _statistics.Close();
         }
     }
 
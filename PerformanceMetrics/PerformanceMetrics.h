@@ -20,15 +20,28 @@
 #pragma once
 
 #include "Module.h"
+#include "MetricsRegistry.h"
 #include <interfaces/IMemory.h>
 #include <interfaces/IBrowser.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <map>
 #include <memory>
+#include <sstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <time.h>
+#include <unistd.h>
 
 namespace Thunder {
 namespace Plugin {
 
-    class PerformanceMetrics : public PluginHost::IPlugin {
+    class PerformanceMetrics : public PluginHost::IPlugin, public PluginHost::JSONRPC {
 
     private:
         class Config : public Core::JSON::Container {
@@ -36,19 +49,119 @@ namespace Plugin {
             Config(const Config&);
             Config& operator=(const Config&);
 
+        public:
+            class SamplingConfig : public Core::JSON::Container {
+            public:
+                SamplingConfig& operator=(const SamplingConfig&) = delete;
+
+                SamplingConfig()
+                    : Core::JSON::Container()
+                    , Interval(0)
+                    , Capacity(1200)
+                    , Settle(5000)
+                    , FrameRate(0)
+                {
+                    Add(_T("interval"), &Interval);
+                    Add(_T("capacity"), &Capacity);
+                    Add(_T("settle"), &Settle);
+                    Add(_T("framerate"), &FrameRate);
+                }
+                SamplingConfig(const SamplingConfig& copy)
+                    : Core::JSON::Container()
+                    , Interval(copy.Interval)
+                    , Capacity(copy.Capacity)
+                    , Settle(copy.Settle)
+                    , FrameRate(copy.FrameRate)
+                {
+                    Add(_T("interval"), &Interval);
+                    Add(_T("capacity"), &Capacity);
+                    Add(_T("settle"), &Settle);
+                    Add(_T("framerate"), &FrameRate);
+                }
+                ~SamplingConfig() override = default;
+
+            public:
+                Core::JSON::DecUInt16 Interval;
+                Core::JSON::DecUInt16 Capacity;
+                Core::JSON::DecUInt16 Settle;
+                Core::JSON::DecUInt8 FrameRate;
+            };
+
+            class BenchmarkConfig : public Core::JSON::Container {
+            public:
+                BenchmarkConfig& operator=(const BenchmarkConfig&) = delete;
+
+                BenchmarkConfig()
+                    : Core::JSON::Container()
+                    , URLs()
+                    , Iterations(10)
+                    , Delay(10)
+                    , Pause(1000)
+                    , Timeout(60)
+                    , Report()
+                {
+                    Add(_T("urls"), &URLs);
+                    Add(_T("iterations"), &Iterations);
+                    Add(_T("delay"), &Delay);
+                    Add(_T("pause"), &Pause);
+                    Add(_T("timeout"), &Timeout);
+                    Add(_T("report"), &Report);
+                }
+                BenchmarkConfig(const BenchmarkConfig& copy)
+                    : Core::JSON::Container()
+                    , URLs(copy.URLs)
+                    , Iterations(copy.Iterations)
+                    , Delay(copy.Delay)
+                    , Pause(copy.Pause)
+                    , Timeout(copy.Timeout)
+                    , Report(copy.Report)
+                {
+                    Add(_T("urls"), &URLs);
+                    Add(_T("iterations"), &Iterations);
+                    Add(_T("delay"), &Delay);
+                    Add(_T("pause"), &Pause);
+                    Add(_T("timeout"), &Timeout);
+                    Add(_T("report"), &Report);
+                }
+                ~BenchmarkConfig() override = default;
+
+            public:
+                Core::JSON::ArrayType<Core::JSON::String> URLs;
+                Core::JSON::DecUInt16 Iterations;
+                Core::JSON::DecUInt16 Delay; // s
+                Core::JSON::DecUInt16 Pause; // ms
+                Core::JSON::DecUInt16 Timeout; // s
+                Core::JSON::String Report;
+            };
+
         public:
             Config()
                 : Core::JSON::Container()
                 , ObservableCallsign()
                 , ObservableClassname()
+                , ObservableCallsigns()
+                , ObservableClassnames()
+                , Sampling()
+                , Benchmark()
+                , UIReady()
             {
                 Add(_T("callsign"), &ObservableCallsign);
                 Add(_T("classname"), &ObservableClassname);
+                Add(_T("callsigns"), &ObservableCallsigns);
+                Add(_T("classnames"), &ObservableClassnames);
+                Add(_T("sampling"), &Sampling);
+                Add(_T("benchmark"), &Benchmark);
+                Add(_T("uiready"), &UIReady);
             }
 
         public:
             Core::JSON::String ObservableCallsign;
             Core::JSON::String ObservableClassname;
+            Core::JSON::ArrayType<Core::JSON::String> ObservableCallsigns; // glob patterns
+            Core::JSON::ArrayType<Core::JSON::String> ObservableClassnames; // glob patterns
+            SamplingConfig Sampling;
+            BenchmarkConfig Benchmark; // drive the observed browser through these URLs, browsers only
+            Core::JSON::String UIReady; // profile the boot up to the activation of this callsign
         };
 
         class Notification : public PluginHost::IPlugin::INotification {
@@ -87,12 +200,1427 @@ namespace Plugin {
             PerformanceMetrics& _parent;
         };
 
-    private:
+    private:
+
+        template<class LOGGERINTERFACE>
+        static std::unique_ptr<LOGGERINTERFACE> LoggerFactory();
+
+    public:
+
+        // Timeline of a single navigation: every phase is recorded as the time (ms) passed since the URL change,
+        // on a monotonic clock, so wall clock adjustments during a load do not end up in the figures. The phases
+        // of all navigations are also aggregated per origin, to tell a slow network/server from a slow page.
+        class PageLoadTimeline {
+        public:
+            enum phase : uint8_t {
+                COMMITTED, // the browser reported the URL as loaded (first response)
+                VISIBLE, // the browser was made visible
+                FINISHED, // the load finished or failed
+                PHASES
+            };
+
+            using Phases = std::array<uint32_t, PHASES>;
+
+            class Aggregate {
+            public:
+                Aggregate()
+                    : _loads(0)
+                    , _failures(0)
+                    , _count()
+                    , _total()
+                {
+                    _count.fill(0);
+                    _total.fill(0);
+                }
+                ~Aggregate() = default;
+
+                Aggregate(const Aggregate&) = default;
+                Aggregate& operator=(const Aggregate&) = default;
+
+                void Add(const Phases& phases, const bool success)
+                {
+                    ++_loads;
+                    if (success == false) {
+                        ++_failures;
+                    }
+                    for (uint8_t index = 0; index < PHASES; ++index) {
+                        if (phases[index] != 0) {
+                            ++_count[index];
+                            _total[index] += phases[index];
+                        }
+                    }
+                }
+                uint32_t Loads() const
+                {
+                    return _loads;
+                }
+                uint32_t Failures() const
+                {
+                    return _failures;
+                }
+                uint32_t Average(const phase which) const
+                {
+                    return (_count[which] != 0 ? static_cast<uint32_t>(_total[which] / _count[which]) : 0);
+                }
+
+            private:
+                uint32_t _loads;
+                uint32_t _failures;
+                std::array<uint32_t, PHASES> _count;
+                std::array<uint64_t, PHASES> _total;
+            };
+
+        private:
+            // Bound the bookkeeping, a browser might visit an endless stream of origins.
+            static constexpr uint8_t maxOrigins = 32;
+
+            using Clock = std::chrono::steady_clock;
+
+        public:
+            PageLoadTimeline()
+                : _URL()
+                , _origin()
+                , _start()
+                , _phases()
+                , _running(false)
+                , _success(false)
+                , _origins()
+            {
+                _phases.fill(0);
+            }
+            ~PageLoadTimeline() = default;
+
+            PageLoadTimeline(const PageLoadTimeline&) = delete;
+            PageLoadTimeline& operator=(const PageLoadTimeline&) = delete;
+
+        public:
+            void URLChange(const string& URL, const bool loaded)
+            {
+                if (loaded == true) {
+                    Mark(COMMITTED);
+                } else if (_running == false) {
+                    _start = Clock::now();
+                    _phases.fill(0);
+                    _running = true;
+                }
+
+                // A redirect within a running navigation does not restart the clock.
+                _URL = URL;
+            }
+            void Visible()
+            {
+                Mark(VISIBLE);
+            }
+            // Returns true if this concluded a navigation that was being timed.
+            bool Finished(const string& URL, const bool success)
+            {
+                bool result = _running;
+
+                if (_running == true) {
+                    Mark(FINISHED);
+
+                    _URL = URL;
+                    _origin = Origin(URL);
+                    _success = success;
+                    _running = false;
+
+                    if ((_origins.size() >= maxOrigins) && (_origins.find(_origin) == _origins.end())) {
+                        _origins.clear();
+                    }
+                    _origins[_origin].Add(_phases, success);
+                }
+
+                return (result);
+            }
+            void Reset()
+            {
+                _running = false;
+                _origins.clear();
+            }
+
+            const string& URL() const
+            {
+                return _URL;
+            }
+            const string& Origin() const
+            {
+                return _origin;
+            }
+            bool Success() const
+            {
+                return _success;
+            }
+            uint32_t Phase(const phase which) const
+            {
+                return _phases[which];
+            }
+            // All navigations to the origin of the last concluded one.
+            const Aggregate& Statistics() const
+            {
+                ASSERT(_origins.find(_origin) != _origins.end());
+                return (_origins.find(_origin)->second);
+            }
+
+            static const TCHAR* Name(const phase which)
+            {
+                return (which == COMMITTED ? _T("committed") :
+                        which == VISIBLE   ? _T("visible") :
+                                             _T("finished"));
+            }
+            // scheme://host[:port] of the URL, the URL itself if it has no authority.
+            static string Origin(const string& URL)
+            {
+                string result(URL);
+                size_t start = URL.find(_T("://"));
+
+                if (start != string::npos) {
+                    size_t end = URL.find_first_of(_T("/?#"), start + 3);
+                    if (end != string::npos) {
+                        result = URL.substr(0, end);
+                    }
+                }
+
+                return (result);
+            }
+
+        private:
+            void Mark(const phase which)
+            {
+                if ((_running == true) && (_phases[which] == 0)) {
+                    const uint64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - _start).count();
+                    // 0 is reserved for "did not happen"
+                    _phases[which] = (elapsed != 0 ? static_cast<uint32_t>(elapsed) : 1);
+                }
+            }
+
+        private:
+            string _URL;
+            string _origin;
+            Clock::time_point _start;
+            Phases _phases;
+            bool _running;
+            bool _success;
+            std::unordered_map<string, Aggregate> _origins;
+        };
+
+        struct SamplerSettings {
+            uint16_t Interval; // ms between two samples, 0 if not sampling
+            uint16_t Capacity; // number of samples kept per load
+            uint16_t Settle; // ms after a suspend before the memory is measured again, 0 if not measuring
+            uint8_t FrameRate; // the rate (fps) a browser should render at, 0 if not sampling the frame rate
+        };
+
+        // Samples the CPU and memory use of all processes of the browser at a high rate while a page loads, as
+        // the peak during the load is what triggers the OOM killer, not what is left once it finished. Samples
+        // go into a buffer allocated up front; peak and integrated values are kept even if the buffer fills up.
+        class PageLoadSampler {
+        public:
+            struct Sample {
+                uint32_t Time; // ms since the start of the load
+                uint64_t Resident; // bytes, all processes together
+                uint64_t CPU; // clock ticks used, all processes together
+            };
+
+        public:
+            PageLoadSampler(const PageLoadSampler&) = delete;
+            PageLoadSampler& operator=(const PageLoadSampler&) = delete;
+
+PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
+            PageLoadSampler()
+                : _memory(nullptr)
+                , _interval(0)
+                , _pids()
+                , _samples()
+                , _start()
+                , _running(false)
+                , _peakResident(0)
+                , _peakCPU(0)
+                , _integral(0)
+                , _cpu(0)
+                , _adminLock()
+                , _job(*this)
+            {
+            }
+POP_WARNING()
+            ~PageLoadSampler()
+            {
+                ASSERT(_memory == nullptr);
+            }
+
+        public:
+            void Enable(PluginHost::IShell& service, const SamplerSettings& settings)
+            {
+                ASSERT(_memory == nullptr);
+
+                if (settings.Interval != 0) {
+                    _memory = service.QueryInterface<Exchange::IMemoryExtended>();
+
+                    if (_memory != nullptr) {
+                        _interval = settings.Interval;
+                        _samples.reserve(std::max(settings.Capacity, static_cast<uint16_t>(2)));
+                    }
+                }
+            }
+            void Disable()
+            {
+                Stop();
+
+                if (_memory != nullptr) {
+                    _memory->Release();
+                    _memory = nullptr;
+                }
+            }
+            bool IsEnabled() const
+            {
+                return (_memory != nullptr);
+            }
+            // A redirect within a running load does not restart the sampling.
+            void Start()
+            {
+                _adminLock.Lock();
+                const bool running = _running;
+                _adminLock.Unlock();
+
+                if ((_memory != nullptr) && (running == false)) {
+                    // The processes are looked up once, they are not expected to come and go during a load.
+                    _pids.clear();
+
+                    Exchange::IMemoryExtended::IStringIterator* iterator = nullptr;
+
+                    if ((_memory->Processes(iterator) == Core::ERROR_NONE) && (iterator != nullptr)) {
+                        string name;
+
+                        while (iterator->Next(name) == true) {
+                            Exchange::IProcessMemory* process = nullptr;
+
+                            if ((_memory->Process(name, process) == Core::ERROR_NONE) && (process != nullptr)) {
+                                if (process->Identifier() != 0) {
+                                    _pids.push_back(process->Identifier());
+                                }
+                                process->Release();
+                            }
+                        }
+                        iterator->Release();
+                    }
+
+                    if (_pids.empty() == false) {
+                        _adminLock.Lock();
+                        _samples.clear();
+                        _peakResident = 0;
+                        _peakCPU = 0;
+                        _integral = 0;
+                        _cpu = 0;
+                        _start = Core::Time::Now().Ticks();
+                        _running = true;
+                        Take();
+                        _adminLock.Unlock();
+
+                        _job.Reschedule(Core::Time::Now().Add(_interval));
+                    }
+                }
+            }
+            // Returns true if a load was being sampled.
+            bool Stop()
+            {
+                _adminLock.Lock();
+                bool result = _running;
+                if (_running == true) {
+                    Take();
+                    _running = false;
+                }
+                _adminLock.Unlock();
+
+                if (result == true) {
+                    _job.Revoke();
+                }
+
+                return (result);
+            }
+
+            // The figures below are only stable once the sampling stopped.
+            uint32_t Samples() const
+            {
+                return (static_cast<uint32_t>(_samples.size()));
+            }
+            const Sample& Last() const
+            {
+                ASSERT(_samples.empty() == false);
+                return (_samples.back());
+            }
+            const Sample& operator[](const uint32_t index) const
+            {
+                ASSERT(index < _samples.size());
+                return (_samples[index]);
+            }
+            uint64_t PeakResident() const
+            {
+                return (_peakResident);
+            }
+            // Average resident memory over time, in bytes.
+            uint64_t AverageResident() const
+            {
+                return ((_samples.empty() == false) && (_samples.back().Time != 0) ? (_integral / _samples.back().Time) : _peakResident);
+            }
+            // Resident memory integrated over time, in KB * s.
+            uint64_t IntegratedResident() const
+            {
+                return (_integral / 1024 / 1000);
+            }
+            // CPU time used by all processes together, in ms.
+            uint32_t CPUTime() const
+            {
+                static const long ticks = sysconf(_SC_CLK_TCK);
+                return (ticks > 0 ? static_cast<uint32_t>((_cpu * 1000) / ticks) : 0);
+            }
+            // Highest CPU load between two samples, in percent of one core.
+            uint32_t PeakCPU() const
+            {
+                return (_peakCPU);
+            }
+
+        private:
+            friend Core::ThreadPool::JobType<PageLoadSampler&>;
+
+            void Dispatch()
+            {
+                _adminLock.Lock();
+                const bool running = _running;
+                if (running == true) {
+                    Take();
+                }
+                _adminLock.Unlock();
+
+                if (running == true) {
+                    _job.Reschedule(Core::Time::Now().Add(_interval));
+                }
+            }
+            // Must be called with the lock taken.
+            void Take()
+            {
+                Sample sample{ static_cast<uint32_t>((Core::Time::Now().Ticks() - _start) / Core::Time::TicksPerMillisecond), 0, 0 };
+
+                for (const uint32_t pid : _pids) {
+                    sample.Resident += Resident(pid);
+                    sample.CPU += CPU(pid);
+                }
+
+                if (_samples.empty() == false) {
+                    const Sample& previous(_samples.back());
+
+                    // The sum drops when one of the processes exits, only what was used in between counts.
+                    if (sample.CPU > previous.CPU) {
+                        _cpu += (sample.CPU - previous.CPU);
+                    }
+
+                    if (sample.Time > previous.Time) {
+                        static const long ticks = sysconf(_SC_CLK_TCK);
+
+                        _integral += previous.Resident * (sample.Time - previous.Time);
+
+                        if ((ticks > 0) && (sample.CPU >= previous.CPU)) {
+                            const uint32_t load = static_cast<uint32_t>(((sample.CPU - previous.CPU) * 1000 * 100) / ticks / (sample.Time - previous.Time));
+                            _peakCPU = std::max(_peakCPU, load);
+                        }
+                    }
+                }
+
+                _peakResident = std::max(_peakResident, sample.Resident);
+
+                if (_samples.size() < _samples.capacity()) {
+                    _samples.push_back(sample);
+                } else {
+                    // Full, keep the latest so the totals still cover the whole load.
+                    _samples.back() = sample;
+                }
+            }
+            static uint64_t Resident(const uint32_t pid)
+            {
+                static const long pagesize = sysconf(_SC_PAGESIZE);
+
+                uint64_t result = 0;
+                char path[32];
+                snprintf(path, sizeof(path), "/proc/%u/statm", pid);
+
+                FILE* file = fopen(path, "r");
+
+                if (file != nullptr) {
+                    unsigned long size, resident;
+
+                    if (fscanf(file, "%lu %lu", &size, &resident) == 2) {
+                        result = static_cast<uint64_t>(resident) * pagesize;
+                    }
+                    fclose(file);
+                }
+
+                return (result);
+            }
+            static uint64_t CPU(const uint32_t pid)
+            {
+                uint64_t result = 0;
+                char path[32];
+                snprintf(path, sizeof(path), "/proc/%u/stat", pid);
+
+                FILE* file = fopen(path, "r");
+
+                if (file != nullptr) {
+                    char line[512];
+
+                    if (fgets(line, sizeof(line), file) != nullptr) {
+                        // The process name might hold spaces and parentheses, the fields start after the last ')'.
+                        const char* fields = strrchr(line, ')');
+                        unsigned long utime, stime;
+
+                        if ((fields != nullptr) && (sscanf(fields + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime) == 2)) {
+                            result = static_cast<uint64_t>(utime) + stime;
+                        }
+                    }
+                    fclose(file);
+                }
+
+                return (result);
+            }
+
+        private:
+            Exchange::IMemoryExtended* _memory;
+            uint16_t _interval;
+            std::vector<uint32_t> _pids;
+            std::vector<Sample> _samples;
+            uint64_t _start;
+            bool _running;
+            uint64_t _peakResident;
+            uint32_t _peakCPU;
+            uint64_t _integral; // bytes * ms
+            uint64_t _cpu; // clock ticks used, without the ticks of processes that exited
+            mutable Core::CriticalSection _adminLock;
+            Core::WorkerPool::JobType<PageLoadSampler&> _job;
+        };
+
+        struct BenchmarkSettings {
+            std::vector<string> URLs;
+            uint16_t Iterations; // loads of every URL
+            uint16_t Delay; // s after the activation before the first load, to let the browser settle
+            uint16_t Pause; // ms between a load concluding and the next one
+            uint16_t Timeout; // s before a load that did not conclude counts as failed
+            string Report; // file the report is written to
+        };
+
+        // Drives a browser through a fixed list of URLs a number of times, one load after the other, and writes
+        // the load times and peak memory use per URL, as percentiles, to a JSON report once all loads are done.
+        // Meant to be pointed at a local server (or file:// pages) to get figures that do not depend on the network.
+        class LoadBenchmark {
+        public:
+            struct INavigator {
+                virtual ~INavigator() = default;
+
+                virtual void Navigate(const string& URL) = 0;
+            };
+
+        private:
+            struct Result {
+                uint32_t Finished; // ms
+                uint64_t PeakResident; // bytes, 0 if the load was not sampled
+                bool Success;
+            };
+
+            class PercentilesAsJson : public Core::JSON::Container {
+            public:
+                PercentilesAsJson& operator=(const PercentilesAsJson&) = delete;
+
+                PercentilesAsJson()
+                    : Core::JSON::Container()
+                {
+                    Init();
+                }
+                PercentilesAsJson(const PercentilesAsJson& copy)
+                    : Core::JSON::Container()
+                    , Min(copy.Min)
+                    , P50(copy.P50)
+                    , P90(copy.P90)
+                    , P95(copy.P95)
+                    , Max(copy.Max)
+                {
+                    Init();
+                }
+                ~PercentilesAsJson() override = default;
+
+                void Values(std::vector<uint64_t>& values)
+                {
+                    if (values.empty() == false) {
+                        std::sort(values.begin(), values.end());
+                        Min = values.front();
+                        P50 = Percentile(values, 50);
+                        P90 = Percentile(values, 90);
+                        P95 = Percentile(values, 95);
+                        Max = values.back();
+                    }
+                }
+
+            private:
+                void Init()
+                {
+                    Add(_T("min"), &Min);
+                    Add(_T("p50"), &P50);
+                    Add(_T("p90"), &P90);
+                    Add(_T("p95"), &P95);
+                    Add(_T("max"), &Max);
+                }
+                // Nearest rank on sorted values.
+                static uint64_t Percentile(const std::vector<uint64_t>& sorted, const uint8_t percentile)
+                {
+                    const size_t rank = ((sorted.size() * percentile) + 99) / 100;
+                    return (sorted[rank > 0 ? rank - 1 : 0]);
+                }
+
+            public:
+                Core::JSON::DecUInt64 Min;
+                Core::JSON::DecUInt64 P50;
+                Core::JSON::DecUInt64 P90;
+                Core::JSON::DecUInt64 P95;
+                Core::JSON::DecUInt64 Max;
+            };
+
+            class EntryAsJson : public Core::JSON::Container {
+            public:
+                EntryAsJson& operator=(const EntryAsJson&) = delete;
+
+                EntryAsJson()
+                    : Core::JSON::Container()
+                {
+                    Init();
+                }
+                EntryAsJson(const EntryAsJson& copy)
+                    : Core::JSON::Container()
+                    , URL(copy.URL)
+                    , Loads(copy.Loads)
+                    , Failures(copy.Failures)
+                    , Finished(copy.Finished)
+                    , PeakRSS(copy.PeakRSS)
+                {
+                    Init();
+                }
+                ~EntryAsJson() override = default;
+
+            private:
+                void Init()
+                {
+                    Add(_T("url"), &URL);
+                    Add(_T("loads"), &Loads);
+                    Add(_T("failures"), &Failures);
+                    Add(_T("finished"), &Finished);
+                    Add(_T("peakrss"), &PeakRSS);
+                }
+
+            public:
+                Core::JSON::String URL;
+                Core::JSON::DecUInt32 Loads;
+                Core::JSON::DecUInt32 Failures;
+                PercentilesAsJson Finished; // ms, successful loads only
+                PercentilesAsJson PeakRSS; // KB, sampled successful loads only
+            };
+
+            class ReportAsJson : public Core::JSON::Container {
+            public:
+                ReportAsJson(const ReportAsJson&) = delete;
+                ReportAsJson& operator=(const ReportAsJson&) = delete;
+
+                ReportAsJson()
+                    : Core::JSON::Container()
+                    , Iterations()
+                    , URLs()
+                {
+                    Add(_T("iterations"), &Iterations);
+                    Add(_T("urls"), &URLs);
+                }
+                ~ReportAsJson() override = default;
+
+            public:
+                Core::JSON::DecUInt16 Iterations;
+                Core::JSON::ArrayType<EntryAsJson> URLs;
+            };
+
+        public:
+            LoadBenchmark() = delete;
+            LoadBenchmark(const LoadBenchmark&) = delete;
+            LoadBenchmark& operator=(const LoadBenchmark&) = delete;
+
+PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
+            explicit LoadBenchmark(INavigator& navigator)
+                : _navigator(navigator)
+                , _settings()
+                , _results()
+                , _loads(0)
+                , _running(false)
+                , _waiting(false)
+                , _adminLock()
+                , _job(*this)
+            {
+            }
+POP_WARNING()
+            ~LoadBenchmark() = default;
+
+        public:
+            void Start(const BenchmarkSettings& settings)
+            {
+                if ((settings.URLs.empty() == false) && (settings.Iterations != 0)) {
+                    _adminLock.Lock();
+                    _settings = settings;
+                    _results.assign(settings.URLs.size(), std::vector<Result>());
+                    for (std::vector<Result>& results : _results) {
+                        results.reserve(settings.Iterations);
+                    }
+                    _loads = 0;
+                    _waiting = false;
+                    _running = true;
+                    _adminLock.Unlock();
+
+                    SYSLOG(Logging::Notification, (_T("Load benchmark of %u URLs, %u iterations, starts in %u s"),
+                                                   static_cast<uint32_t>(settings.URLs.size()), settings.Iterations, settings.Delay));
+
+                    _job.Reschedule(Core::Time::Now().Add(settings.Delay * 1000));
+                }
+            }
+            void Stop()
+            {
+                _adminLock.Lock();
+                _running = false;
+                _adminLock.Unlock();
+
+                _job.Revoke();
+            }
+            // A load concluded, peakResident is 0 if it was not sampled. A load that concludes after it timed out
+            // is not the one that is waited for now, so it is ignored rather than recorded against the next URL.
+            void Loaded(const PageLoadTimeline& timeline, const uint64_t peakResident)
+            {
+                _adminLock.Lock();
+                const bool next = ((_running == true) && (_waiting == true) && (Matches(_settings.URLs[_loads % _settings.URLs.size()], timeline.URL()) == true));
+                if (next == true) {
+                    Record(timeline.Phase(PageLoadTimeline::FINISHED), peakResident, timeline.Success());
+                }
+                _adminLock.Unlock();
+
+                if (next == true) {
+                    _job.Reschedule(Core::Time::Now().Add(_settings.Pause));
+                }
+            }
+
+        private:
+            friend Core::ThreadPool::JobType<LoadBenchmark&>;
+
+            // The browser might report the URL normalized, e.g. with a slash appended to the host. The benchmark
+            // URLs should not redirect, or their loads are never matched and end up as time outs.
+            static bool Matches(const string& requested, const string& reported)
+            {
+                const size_t left = (((requested.empty() == false) && (requested.back() == '/')) ? requested.length() - 1 : requested.length());
+                const size_t right = (((reported.empty() == false) && (reported.back() == '/')) ? reported.length() - 1 : reported.length());
+
+                return ((left == right) && (requested.compare(0, left, reported, 0, right) == 0));
+            }
+
+            void Dispatch()
+            {
+                string URL;
+
+                _adminLock.Lock();
+
+                if (_running == true) {
+                    if (_waiting == true) {
+                        TRACE(Trace::Information, (_T("Load benchmark: load %u did not conclude in time"), _loads));
+                        Record(_settings.Timeout * 1000, 0, false);
+                    }
+
+                    if (_loads < (_settings.URLs.size() * _settings.Iterations)) {
+                        URL = _settings.URLs[_loads % _settings.URLs.size()];
+                        _waiting = true;
+                    } else {
+                        _running = false;
+                        Report();
+                    }
+                }
+
+                _adminLock.Unlock();
+
+                if (URL.empty() == false) {
+                    // Armed before navigating, so a load concluding right away is not overtaken by the timeout.
+                    _job.Reschedule(Core::Time::Now().Add(_settings.Timeout * 1000));
+                    _navigator.Navigate(URL);
+                }
+            }
+            // Must be called with the lock taken.
+            void Record(const uint32_t finished, const uint64_t peakResident, const bool success)
+            {
+                _results[_loads % _settings.URLs.size()].push_back({ finished, peakResident, success });
+                _loads++;
+                _waiting = false;
+            }
+            // Must be called with the lock taken.
+            void Report() const
+            {
+                ReportAsJson report;
+                report.Iterations = _settings.Iterations;
+
+                for (uint32_t index = 0; index < _settings.URLs.size(); index++) {
+                    EntryAsJson& entry(report.URLs.Add());
+                    std::vector<uint64_t> finished;
+                    std::vector<uint64_t> resident;
+                    uint32_t failures = 0;
+
+                    for (const Result& result : _results[index]) {
+                        if (result.Success == false) {
+                            failures++;
+                        } else {
+                            finished.push_back(result.Finished);
+                            if (result.PeakResident != 0) {
+                                resident.push_back(result.PeakResident / 1024);
+                            }
+                        }
+                    }
+
+                    entry.URL = _settings.URLs[index];
+                    entry.Loads = static_cast<uint32_t>(_results[index].size());
+                    entry.Failures = failures;
+                    entry.Finished.Values(finished);
+                    entry.PeakRSS.Values(resident);
+                }
+
+                string output;
+                report.ToString(output);
+
+                Core::File file(_settings.Report);
+
+                if (file.Create() == true) {
+                    file.Write(reinterpret_cast<const uint8_t*>(output.c_str()), static_cast<uint32_t>(output.length()));
+                    file.Close();
+                    SYSLOG(Logging::Notification, (_T("Load benchmark done, report written to %s"), _settings.Report.c_str()));
+                } else {
+                    SYSLOG(Logging::Error, (_T("Load benchmark done, could not write the report to %s: %s"), _settings.Report.c_str(), output.c_str()));
+                }
+            }
+
+        private:
+            INavigator& _navigator;
+            BenchmarkSettings _settings;
+            std::vector<std::vector<Result>> _results; // per URL
+            uint32_t _loads;
+            bool _running;
+            bool _waiting;
+            mutable Core::CriticalSection _adminLock;
+            Core::WorkerPool::JobType<LoadBenchmark&> _job;
+        };
+
+        // What suspending a plugin gives back: the resident memory when the suspend is reported and once it had
+        // time to settle (garbage collection, purged caches), aggregated over all suspends since the activation.
+        // A resume before the memory settled does not count, the suspend was too short to tell.
+        class SuspendReclaim {
+        public:
+            SuspendReclaim(const SuspendReclaim&) = delete;
+            SuspendReclaim& operator=(const SuspendReclaim&) = delete;
+
+            SuspendReclaim()
+                : _suspendedAt(0)
+                , _before(0)
+                , _settled(0)
+                , _pending(false)
+                , _suspends(0)
+                , _interrupted(0)
+                , _total(0)
+                , _peak(0)
+                , _suspended(0)
+            {
+            }
+            ~SuspendReclaim() = default;
+
+        public:
+            void Suspended(const uint64_t resident)
+            {
+                _suspendedAt = Core::Time::Now().Ticks();
+                _before = resident;
+                _pending = true;
+            }
+            void Settled(const uint64_t resident)
+            {
+                ASSERT(_pending == true);
+
+                _settled = resident;
+                _pending = false;
+                _suspends++;
+                _total += Reclaimed();
+                _peak = std::max(_peak, Reclaimed());
+            }
+            void Resumed()
+            {
+                if (_pending == true) {
+                    _pending = false;
+                    _interrupted++;
+                }
+                if (_suspendedAt != 0) {
+                    _suspended += (Core::Time::Now().Ticks() - _suspendedAt) / Core::Time::TicksPerMillisecond;
+                    _suspendedAt = 0;
+                }
+            }
+            bool Pending() const
+            {
+                return (_pending);
+            }
+
+            // All memory figures are in bytes.
+            uint64_t Before() const
+            {
+                return (_before);
+            }
+            uint64_t After() const
+            {
+                return (_settled);
+            }
+            uint64_t Reclaimed() const
+            {
+                return (_before > _settled ? (_before - _settled) : 0);
+            }
+            uint32_t Suspends() const
+            {
+                return (_suspends);
+            }
+            uint32_t Interrupted() const
+            {
+                return (_interrupted);
+            }
+            uint64_t AverageReclaimed() const
+            {
+                return (_suspends != 0 ? (_total / _suspends) : 0);
+            }
+            uint64_t PeakReclaimed() const
+            {
+                return (_peak);
+            }
+            // Time spent in completed suspends, in ms.
+            uint64_t SuspendedTime() const
+            {
+                return (_suspended);
+            }
+
+        private:
+            uint64_t _suspendedAt;
+            uint64_t _before;
+            uint64_t _settled;
+            bool _pending;
+            uint32_t _suspends;
+            uint32_t _interrupted;
+            uint64_t _total;
+            uint64_t _peak;
+            uint64_t _suspended;
+        };
+
+        // Samples the frame rate the browser reports while it is visible, and keeps a histogram of it per visible
+        // period on a URL. The browser counts the frames its compositor displayed and updates the rate once per
+        // second, so that is the rate it is polled at; while hidden nothing is rendered and nothing is polled.
+        // Needs the "fps" option of the browser, and a page that renders nothing keeps reporting its last rate.
+        class FrameRateSampler {
+        public:
+            struct ISource {
+                virtual ~ISource() = default;
+
+                virtual uint8_t FrameRate() const = 0;
+            };
+
+            static constexpr uint8_t BucketWidth = 5; // fps
+            static constexpr uint8_t Buckets = 13; // the last one holds 60 fps and up
+
+        public:
+            FrameRateSampler() = delete;
+            FrameRateSampler(const FrameRateSampler&) = delete;
+            FrameRateSampler& operator=(const FrameRateSampler&) = delete;
+
+PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
+            explicit FrameRateSampler(ISource& source)
+                : _source(source)
+                , _target(0)
+                , _URL()
+                , _buckets()
+                , _seconds(0)
+                , _frames(0)
+                , _minimum(0)
+                , _dropped(0)
+                , _janky(0)
+                , _running(false)
+                , _adminLock()
+                , _job(*this)
+            {
+                _buckets.fill(0);
+            }
+POP_WARNING()
+            ~FrameRateSampler() = default;
+
+        public:
+            void Enable(const SamplerSettings& settings)
+            {
+                _target = settings.FrameRate;
+            }
+            void Disable()
+            {
+                Stop();
+                _target = 0;
+            }
+
+            // The browser became visible, or navigated while visible.
+            void Start(const string& URL)
+            {
+                if (_target != 0) {
+                    _adminLock.Lock();
+                    const bool start = (_running == false);
+                    if (start == true) {
+                        _URL = URL;
+                        _buckets.fill(0);
+                        _seconds = 0;
+                        _frames = 0;
+                        _minimum = ~0;
+                        _dropped = 0;
+                        _janky = 0;
+                        _running = true;
+                    }
+                    _adminLock.Unlock();
+
+                    if (start == true) {
+                        _job.Reschedule(Core::Time::Now().Add(1000));
+                    }
+                }
+            }
+            // Returns true if anything was sampled since the start.
+            bool Stop()
+            {
+                _adminLock.Lock();
+                const bool stop = _running;
+                _running = false;
+                _adminLock.Unlock();
+
+                if (stop == true) {
+                    _job.Revoke();
+                }
+
+                return ((stop == true) && (_seconds != 0));
+            }
+            bool IsRunning() const
+            {
+                return (_running);
+            }
+
+            // The figures below are only stable once the sampling stopped.
+            const string& URL() const
+            {
+                return (_URL);
+            }
+            uint8_t Target() const
+            {
+                return (_target);
+            }
+            uint32_t Seconds() const
+            {
+                return (_seconds);
+            }
+            uint32_t Average() const
+            {
+                return (_seconds != 0 ? static_cast<uint32_t>(_frames / _seconds) : 0);
+            }
+            uint32_t Minimum() const
+            {
+                return (_seconds != 0 ? _minimum : 0);
+            }
+            // Frames short of the target rate, over all samples.
+            uint64_t Dropped() const
+            {
+                return (_dropped);
+            }
+            // Seconds the rate was below 3/4 of the target.
+            uint32_t Janky() const
+            {
+                return (_janky);
+            }
+            // Seconds the rate was in [index * BucketWidth, (index + 1) * BucketWidth).
+            uint32_t Bucket(const uint8_t index) const
+            {
+                ASSERT(index < Buckets);
+                return (_buckets[index]);
+            }
+
+        private:
+            friend Core::ThreadPool::JobType<FrameRateSampler&>;
+
+            void Dispatch()
+            {
+                const uint8_t rate = _source.FrameRate();
+
+                _adminLock.Lock();
+                const bool running = _running;
+                if (running == true) {
+                    _buckets[std::min(static_cast<uint8_t>(rate / BucketWidth), static_cast<uint8_t>(Buckets - 1))]++;
+                    _seconds++;
+                    _frames += rate;
+                    _minimum = std::min(_minimum, static_cast<uint32_t>(rate));
+                    if (rate < _target) {
+                        _dropped += (_target - rate);
+                    }
+                    if ((static_cast<uint32_t>(rate) * 4) < (static_cast<uint32_t>(_target) * 3)) {
+                        _janky++;
+                    }
+                }
+                _adminLock.Unlock();
+
+                if (running == true) {
+                    _job.Reschedule(Core::Time::Now().Add(1000));
+                }
+            }
+
+        private:
+            ISource& _source;
+            uint8_t _target;
+            string _URL;
+            std::array<uint32_t, Buckets> _buckets;
+            uint32_t _seconds;
+            uint64_t _frames;
+            uint32_t _minimum;
+            uint64_t _dropped;
+            uint32_t _janky;
+            bool _running;
+            mutable Core::CriticalSection _adminLock;
+            Core::WorkerPool::JobType<FrameRateSampler&> _job;
+        };
+
+        // Launch times of the browsers per callsign, kept in a compact histogram that survives reboots, so builds
+        // can be compared on percentiles without collecting every single launch from the boxes:
+        //  - cold: the first load of an app (origin) that was requested within 2s of the activation
+        //  - warm: the first load of any other app
+        //  - firstload: from the activation up to the first load that concluded successfully
+        class LaunchStatistics {
+        public:
+            enum kind : uint8_t {
+                COLD,
+                WARM,
+                FIRSTLOAD,
+                KINDS
+            };
+
+            // 4 buckets per power of two from 8ms on, the upper bound of a bucket is within 25% of the values
+            // in it, the last one collects everything beyond ~6.5 minutes.
+            class Histogram {
+            public:
+                static constexpr uint8_t Buckets = 64;
+
+                Histogram()
+                    : _count(0)
+                    , _buckets()
+                {
+                    _buckets.fill(0);
+                }
+                ~Histogram() = default;
+
+                Histogram(const Histogram&) = default;
+                Histogram& operator=(const Histogram&) = default;
+
+            public:
+                void Add(const uint32_t ms)
+                {
+                    Add(Bucket(ms), 1);
+                }
+                void Add(const uint8_t bucket, const uint32_t count)
+                {
+                    ASSERT(bucket < Buckets);
+                    _buckets[bucket] += count;
+                    _count += count;
+                }
+                uint32_t Count() const
+                {
+                    return (_count);
+                }
+                uint32_t Count(const uint8_t bucket) const
+                {
+                    return (_buckets[bucket]);
+                }
+                // Upper bound (ms) of the bucket holding the nearest rank.
+                uint32_t Percentile(const uint8_t percentile) const
+                {
+                    uint32_t result = 0;
+
+                    if (_count != 0) {
+                        const uint32_t rank = std::max(1u, static_cast<uint32_t>(((static_cast<uint64_t>(_count) * percentile) + 99) / 100));
+                        uint32_t seen = 0;
+                        uint8_t index = 0;
+
+                        while ((seen += _buckets[index]) < rank) {
+                            index++;
+                        }
+
+                        result = Upper(index);
+                    }
+
+                    return (result);
+                }
+
+                static uint8_t Bucket(const uint32_t ms)
+                {
+                    uint8_t result = 0;
+
+                    if (ms >= 8) {
+                        uint8_t exponent = 3;
+                        while ((ms >> (exponent + 1)) != 0) {
+                            exponent++;
+                        }
+                        result = std::min(static_cast<uint32_t>(Buckets - 1), 1 + ((exponent - 3) * 4) + ((ms >> (exponent - 2)) & 0x3));
+                    }
+
+                    return (result);
+                }
+                static uint32_t Upper(const uint8_t bucket)
+                {
+                    return (bucket == 0 ? 8 : ((5 + ((bucket - 1) % 4)) << (1 + ((bucket - 1) / 4))));
+                }
+
+            private:
+                uint32_t _count;
+                std::array<uint32_t, Buckets> _buckets;
+            };
+
+            using Histograms = std::array<Histogram, KINDS>;
+
+            // Per activation of a browser, tells a launch apart from any other navigation.
+            class Launches {
+            public:
+                Launches()
+                    : _activated(0)
+                    , _origin()
+                    , _loaded(false)
+                {
+                }
+                ~Launches() = default;
+
+                Launches(const Launches&) = delete;
+                Launches& operator=(const Launches&) = delete;
+
+                void Activated()
+                {
+                    _activated = Core::Time::Now().Ticks();
+                    _origin.clear();
+                    _loaded = false;
+                }
+
+            private:
+                friend class LaunchStatistics;
+
+                uint64_t _activated;
+                string _origin;
+                bool _loaded;
+            };
+
+        private:
+            // Bound the file, a classname or pattern might match an endless stream of callsigns.
+            static constexpr uint8_t maxCallsigns = 64;
+            static constexpr uint32_t coldWindow = 2000; // ms
+
+        public:
+            LaunchStatistics(const LaunchStatistics&) = delete;
+            LaunchStatistics& operator=(const LaunchStatistics&) = delete;
+
+PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
+            LaunchStatistics()
+                : _fileName()
+                , _callsigns()
+                , _dirty(false)
+                , _adminLock()
+                , _job(*this)
+            {
+            }
+POP_WARNING()
+            ~LaunchStatistics() = default;
+
+        public:
+            void Open(const string& fileName)
+            {
+                _adminLock.Lock();
+
+                _fileName = fileName;
+                _callsigns.clear();
+                _dirty = false;
+
+                std::ifstream file(_fileName);
+                string line;
+
+                while (std::getline(file, line)) {
+                    std::istringstream fields(line);
+                    string callsign;
+                    string name;
+
+                    if ((fields >> callsign >> name) && ((_callsigns.size() < maxCallsigns) || (_callsigns.find(callsign) != _callsigns.end()))) {
+                        uint8_t which = 0;
+                        while ((which < KINDS) && (name != Name(static_cast<kind>(which)))) {
+                            which++;
+                        }
+
+                        if (which < KINDS) {
+                            Histogram& histogram(_callsigns[callsign][which]);
+                            uint32_t bucket;
+                            uint32_t count;
+                            char separator;
+
+                            while ((fields >> bucket >> separator >> count) && (separator == ':') && (bucket < Histogram::Buckets)) {
+                                histogram.Add(static_cast<uint8_t>(bucket), count);
+                            }
+                        }
+                    }
+                }
+
+                _adminLock.Unlock();
+            }
+            void Close()
+            {
+                _job.Revoke();
+
+                // Whatever was not written yet, is written now.
+                Dispatch();
+
+                _adminLock.Lock();
+                _callsigns.clear();
+                _fileName.clear();
+                _adminLock.Unlock();
+            }
+
+            // A navigation of the browser with this callsign concluded.
+            void Concluded(const string& callsign, Launches& launches, const PageLoadTimeline& timeline)
+            {
+                if (timeline.Success() == true) {
+                    const uint64_t now = Core::Time::Now().Ticks();
+                    const uint32_t finished = timeline.Phase(PageLoadTimeline::FINISHED);
+
+                    bool updated = false;
+
+                    _adminLock.Lock();
+
+                    if ((_callsigns.size() < maxCallsigns) || (_callsigns.find(callsign) != _callsigns.end())) {
+                        Histograms& histograms(_callsigns[callsign]);
+
+                        if (launches._loaded == false) {
+                            histograms[FIRSTLOAD].Add(static_cast<uint32_t>((now - launches._activated) / Core::Time::TicksPerMillisecond));
+                            launches._loaded = true;
+                            updated = true;
+                        }
+
+                        if (timeline.Origin() != launches._origin) {
+                            const uint64_t requested = now - (static_cast<uint64_t>(finished) * Core::Time::TicksPerMillisecond);
+                            const bool cold = (requested < (launches._activated + (coldWindow * Core::Time::TicksPerMillisecond)));
+
+                            histograms[cold == true ? COLD : WARM].Add(finished);
+                            launches._origin = timeline.Origin();
+                            updated = true;
+                        }
+
+                        _dirty = (_dirty || updated);
+                    }
+
+                    _adminLock.Unlock();
+
+                    // Navigations within the same origin do not change the histograms, nothing to write for those.
+                    if (updated == true) {
+                        _job.Submit();
+                    }
+                }
+            }
+
+            // Copies out the histograms of the callsign, or of all if empty.
+            void Snapshot(const string& callsign, std::map<string, Histograms>& histograms) const
+            {
+                _adminLock.Lock();
+
+                for (const auto& entry : _callsigns) {
+                    if ((callsign.empty() == true) || (callsign == entry.first)) {
+                        histograms.emplace(entry.first, entry.second);
+                    }
+                }
+
+                _adminLock.Unlock();
+            }
+
+            static const TCHAR* Name(const kind which)
+            {
+                return (which == COLD ? _T("cold") :
+                        which == WARM ? _T("warm") :
+                                        _T("firstload"));
+            }
+
+        private:
+            friend Core::ThreadPool::JobType<LaunchStatistics&>;
+
+            // Launches are rare, so the file is written after every one that changed the histograms. It is written
+            // on a worker, not to hold up the notification, and via a synced temporary file, so a power cut while
+            // writing leaves the previous history in place.
+            void Dispatch()
+            {
+                std::ostringstream content;
+                string fileName;
+
+                _adminLock.Lock();
+
+                if (_dirty == true) {
+                    fileName = _fileName;
+                    _dirty = false;
+
+                    for (const auto& entry : _callsigns) {
+                        for (uint8_t which = 0; which < KINDS; which++) {
+                            const Histogram& histogram(entry.second[which]);
+
+                            if (histogram.Count() != 0) {
+                                content << entry.first << ' ' << Name(static_cast<kind>(which));
+                                for (uint8_t bucket = 0; bucket < Histogram::Buckets; bucket++) {
+                                    if (histogram.Count(bucket) != 0) {
+                                        content << ' ' << static_cast<uint32_t>(bucket) << ':' << histogram.Count(bucket);
+                                    }
+                                }
+                                content << '\n';
+                            }
+                        }
+                    }
+                }
+
+                _adminLock.Unlock();
+
+                if (fileName.empty() == false) {
+                    Save(fileName, content.str());
+                }
+            }
+            static void Save(const string& fileName, const string& content)
+            {
+                const string temporary(fileName + _T(".tmp"));
+                const int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                bool written = false;
+
+                if (fd >= 0) {
+                    size_t offset = 0;
+
+                    while (offset < content.length()) {
+                        const ssize_t result = ::write(fd, &(content[offset]), content.length() - offset);
+
+                        if (result > 0) {
+                            offset += static_cast<size_t>(result);
+                        } else if ((result < 0) && (errno != EINTR)) {
+                            break;
+                        }
+                    }
+
+                    // Only once the content is on disk, the rename may replace the previous file.
+                    written = ((offset == content.length()) && (::fsync(fd) == 0));
 
-        template<class LOGGERINTERFACE>
-        static std::unique_ptr<LOGGERINTERFACE> LoggerFactory();
+                    ::close(fd);
+                }
 
-    public:
+                if ((written == true) && (::rename(temporary.c_str(), fileName.c_str()) == 0)) {
+                    TRACE(Trace::Information, (_T("Launch statistics written to %s"), fileName.c_str()));
+                } else {
+                    TRACE(Trace::Error, (_T("Could not write the launch statistics to %s"), temporary.c_str()));
+                }
+            }
+
+        private:
+            string _fileName;
+            std::map<string, Histograms> _callsigns;
+            bool _dirty;
+            mutable Core::CriticalSection _adminLock;
+            Core::WorkerPool::JobType<LaunchStatistics&> _job;
+        };
 
         class IBasicMetricsLogger {
         public:
@@ -110,6 +1638,8 @@ namespace Plugin {
 
             virtual void Resumed() = 0;
             virtual void Suspended() = 0;
+            // Reported once the memory settled after a suspend.
+            virtual void Reclaimed(const SuspendReclaim& reclaim) = 0;
         };
 
         struct IBrowserMetricsLogger : public IStateMetricsLogger {
@@ -120,6 +1650,40 @@ namespace Plugin {
             virtual void URLChange(const string& URL, const bool loaded) = 0;
             virtual void VisibilityChange(const bool hidden) = 0;
             virtual void PageClosure() = 0;
+            // Reported once a navigation concluded, after LoadFinished.
+            virtual void LoadTimeline(const PageLoadTimeline& timeline) = 0;
+            // Reported once a navigation concluded that was sampled, after LoadTimeline.
+            virtual void LoadResources(const PageLoadSampler& sampler) = 0;
+            // Reported at the end of every visible period on a URL that had its frame rate sampled.
+            virtual void FrameRate(const FrameRateSampler& sampler) = 0;
+        };
+
+        // What it took to get from the start of the framework up to the activation of the "UI ready" plugin.
+        // All times are in ms since the framework process started.
+        struct BootProfile {
+            struct Step {
+                string Callsign;
+                uint32_t Start; // previous activation completed, this one is assumed to take over from there
+                uint32_t End; // activation completed
+                uint32_t Spawned; // its out of process part started, 0 if it has none (or it is unknown)
+            };
+            struct Milestone {
+                string Name;
+                uint32_t Time;
+            };
+
+            string Target;
+            uint32_t ProcessStart; // ms since boot
+            uint32_t Observed; // activations before this were reported all at once, their timing is unknown
+            uint32_t Ready; // the target completed its activation
+            std::vector<Step> Path; // longest step first
+            std::vector<Milestone> Milestones; // subsystems that became active, in order
+        };
+
+        struct IBootMetricsLogger {
+            virtual ~IBootMetricsLogger() = default;
+
+            virtual void CriticalPath(const BootProfile& profile) = 0;
         };
 
     private:
@@ -144,14 +1708,20 @@ namespace Plugin {
 
             virtual void Activated(PluginHost::IShell&) = 0;
             virtual void Deactivated(PluginHost::IShell&) = 0;
+
+            // All plugins that were already active when registering have been reported by now.
+            virtual void Registered() {}
         };
 
         class CallsignPerfMetricsHandler : public IPerfMetricsHandler
         {
         public:
-            CallsignPerfMetricsHandler(const string& callsign) 
+            CallsignPerfMetricsHandler(const string& callsign, LaunchStatistics& statistics, const SamplerSettings& sampling, const BenchmarkSettings& benchmark = BenchmarkSettings())
                 : IPerfMetricsHandler()
                 , _callsign(callsign)
+                , _statistics(statistics)
+                , _sampling(sampling)
+                , _benchmark(benchmark)
                 , _observable()
             {
             }
@@ -169,6 +1739,21 @@ namespace Plugin {
                 return _callsign;
             }
 
+            const SamplerSettings& Sampling() const
+            {
+                return _sampling;
+            }
+
+            const BenchmarkSettings& Benchmark() const
+            {
+                return _benchmark;
+            }
+
+            LaunchStatistics& Statistics() const
+            {
+                return _statistics;
+            }
+
             void Initialize() override
             {
                 ASSERT(_observable.IsValid() == false);
@@ -212,31 +1797,41 @@ namespace Plugin {
 
         private:
             string _callsign;
+            LaunchStatistics& _statistics;
+            const SamplerSettings _sampling;
+            const BenchmarkSettings _benchmark;
             Core::ProxyType<IObservable> _observable;
         };
 
-        class ClassnamePerfMetricsHandler : public IPerfMetricsHandler
+        // Observes every plugin of which the callsign or the classname matches one of the (glob) patterns, each
+        // with its own observable, all served from the single notification sink of this plugin instance.
+        class PatternPerfMetricsHandler : public IPerfMetricsHandler
         {
         public:
-            ClassnamePerfMetricsHandler(const string& classname) 
+            using Patterns = std::vector<string>;
+
+            PatternPerfMetricsHandler(const Patterns& callsigns, const Patterns& classnames, LaunchStatistics& statistics, const SamplerSettings& sampling)
                 : IPerfMetricsHandler()
-                , _classname(classname)
+                , _callsigns(callsigns)
+                , _classnames(classnames)
+                , _statistics(statistics)
+                , _sampling(sampling)
                 , _observers()
                 , _adminLock()
             {
             }
 
-            ~ClassnamePerfMetricsHandler() override 
+            ~PatternPerfMetricsHandler() override 
             {
                 ASSERT(_observers.empty() == true);
             }
 
-            ClassnamePerfMetricsHandler(const ClassnamePerfMetricsHandler&) = delete;
-            ClassnamePerfMetricsHandler& operator=(const ClassnamePerfMetricsHandler&) = delete;
+            PatternPerfMetricsHandler(const PatternPerfMetricsHandler&) = delete;
+            PatternPerfMetricsHandler& operator=(const PatternPerfMetricsHandler&) = delete;
 
-            const string& Classname() const 
+            bool Matches(const PluginHost::IShell& service) const
             {
-                return _classname;
+                return ((Matches(_callsigns, service.Callsign()) == true) || (Matches(_classnames, service.ClassName()) == true));
             }
 
             void Initialize() override
@@ -255,11 +1850,11 @@ namespace Plugin {
 
             void Activated(PluginHost::IShell& service) override
             {
-                if (service.ClassName() == Classname()) {
+                if (Matches(service) == true) {
                     _adminLock.Lock();
                     auto result =_observers.emplace(std::piecewise_construct,
                                        std::forward_as_tuple(service.Callsign()),
-                                       std::forward_as_tuple(service.Callsign()));
+                                       std::forward_as_tuple(service.Callsign(), _statistics, _sampling));
                     ASSERT((result.second == true) && (result.first != _observers.end()));
                     result.first->second.Initialize();
                     result.first->second.Activated(service);
@@ -268,22 +1863,36 @@ namespace Plugin {
             }
             void Deactivated(PluginHost::IShell& service) override
             {
-                if (service.ClassName() == Classname()) {
-                    _adminLock.Lock();
-                    auto it =_observers.find(service.Callsign());
-                    if (it != _observers.end()) {
-                        it->second.Deactivated(service);
-                        it->second.Deinitialize();
-                        _observers.erase(it);
-                    }
-                    _adminLock.Unlock();
+                // Only what was activated is observed, so no need to match the patterns again.
+                _adminLock.Lock();
+                auto it =_observers.find(service.Callsign());
+                if (it != _observers.end()) {
+                    it->second.Deactivated(service);
+                    it->second.Deinitialize();
+                    _observers.erase(it);
+                }
+                _adminLock.Unlock();
+            }
+
+        private:
+            static bool Matches(const Patterns& patterns, const string& name)
+            {
+                Patterns::const_iterator index(patterns.begin());
+
+                while ((index != patterns.end()) && (::fnmatch(index->c_str(), name.c_str(), 0) != 0)) {
+                    index++;
                 }
+
+                return (index != patterns.end());
             }
 
         private:
             using OberserverMap = std::unordered_map<string, CallsignPerfMetricsHandler>;
 
-            string _classname;
+            const Patterns _callsigns;
+            const Patterns _classnames;
+            LaunchStatistics& _statistics;
+            const SamplerSettings _sampling;
             OberserverMap _observers;
             mutable Core::CriticalSection _adminLock;
         };
@@ -292,25 +1901,316 @@ namespace Plugin {
 
         // we cannot make the Logger a static and get it via Instance or something similar as the Plugin (and therefore the library) 
         // might be used multipe times fot different callsigns and the they would share the same Logger instance (and Logger state)
+        // The loggers keep state and are not thread safe, while they are called from the notification threads as
+        // well as from jobs. Every access holds the lock of the proxy up to the end of the statement it is used in.
         template<class LOGGERINTERFACE>
         class LoggerProxy {
         public:
-            LoggerProxy() : _logger(LoggerFactory<LOGGERINTERFACE>()) {}
+            class Access {
+            public:
+                Access(const Access&) = delete;
+                Access& operator=(const Access&) = delete;
+
+                Access(LOGGERINTERFACE& logger, Core::CriticalSection& lock)
+                    : _logger(logger)
+                    , _lock(&lock)
+                {
+                    _lock->Lock();
+                }
+                Access(Access&& move)
+                    : _logger(move._logger)
+                    , _lock(move._lock)
+                {
+                    move._lock = nullptr;
+                }
+                ~Access()
+                {
+                    if (_lock != nullptr) {
+                        _lock->Unlock();
+                    }
+                }
+
+            public:
+                LOGGERINTERFACE* operator->() const
+                {
+                    return (&_logger);
+                }
+
+            private:
+                LOGGERINTERFACE& _logger;
+                Core::CriticalSection* _lock;
+            };
+
+        public:
+            LoggerProxy() : _logger(LoggerFactory<LOGGERINTERFACE>()), _lock() {}
             ~LoggerProxy() = default;
 
-            LOGGERINTERFACE& Logger() 
-            { 
-                ASSERT(_logger.get() != nullptr);
-                return *_logger; 
-            }
-            const LOGGERINTERFACE& Logger() const
+            Access Logger() 
             { 
                 ASSERT(_logger.get() != nullptr);
-                return *_logger; 
+                return (Access(*_logger, _lock));
             }
 
         private:
             std::unique_ptr<LOGGERINTERFACE> _logger; 
+            Core::CriticalSection _lock;
+        };
+
+        // Follows the activation of all plugins from the start of the framework until the "UI ready" plugin is
+        // activated, to tell where the boot time went. The framework activates the plugins one after the other,
+        // so each activation is taken to run from the completion of the previous one up to its own completion.
+        class BootPerfMetricsHandler : public IPerfMetricsHandler, protected LoggerProxy<IBootMetricsLogger> {
+        private:
+            class Sink : public PluginHost::ISubSystem::INotification {
+            public:
+                Sink(const Sink&) = delete;
+                Sink& operator=(const Sink&) = delete;
+
+                explicit Sink(BootPerfMetricsHandler& parent)
+                    : _parent(parent)
+                {
+                }
+                ~Sink() override = default;
+
+                void Updated() override
+                {
+                    _parent.SubsystemsUpdated();
+                }
+
+                BEGIN_INTERFACE_MAP(Sink)
+                INTERFACE_ENTRY(PluginHost::ISubSystem::INotification)
+                END_INTERFACE_MAP
+
+            private:
+                BootPerfMetricsHandler& _parent;
+            };
+
+        public:
+            BootPerfMetricsHandler(const BootPerfMetricsHandler&) = delete;
+            BootPerfMetricsHandler& operator=(const BootPerfMetricsHandler&) = delete;
+
+PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
+            BootPerfMetricsHandler(PluginHost::IShell& service, const string& target)
+                : IPerfMetricsHandler()
+                , LoggerProxy<IBootMetricsLogger>()
+                , _service(service)
+                , _subsystems(nullptr)
+                , _sink(*this)
+                , _profile()
+                , _active(0)
+                , _seen(0)
+                , _registered(false)
+                , _reported(false)
+                , _adminLock()
+            {
+                _profile.Target = target;
+            }
+POP_WARNING()
+            ~BootPerfMetricsHandler() override
+            {
+                ASSERT(_subsystems == nullptr);
+            }
+
+            void Initialize() override
+            {
+                ASSERT(_subsystems == nullptr);
+
+                _profile.ProcessStart = StartTime(0);
+                _profile.Path.reserve(64);
+
+                _subsystems = _service.SubSystems();
+
+                if (_subsystems != nullptr) {
+                    _subsystems->Register(&_sink);
+                    SubsystemsUpdated();
+                }
+            }
+
+            void Deinitialize() override
+            {
+                if (_subsystems != nullptr) {
+                    _subsystems->Unregister(&_sink);
+                    _subsystems->Release();
+                    _subsystems = nullptr;
+                }
+            }
+
+            void Activated(PluginHost::IShell& service) override
+            {
+                const uint32_t now = Now();
+
+                _adminLock.Lock();
+
+                if (_reported == false) {
+                    if (_registered == false) {
+                        // Already active before we were, all we know is that it completed before now.
+                        ++_active;
+                    } else {
+                        const uint32_t start = (_profile.Path.empty() == true ? _profile.Observed : _profile.Path.back().End);
+                        _profile.Path.push_back({ service.Callsign(), start, now, Spawned(service) });
+                    }
+
+                    if (service.Callsign() == _profile.Target) {
+                        _profile.Ready = now;
+                        Report();
+                    }
+                }
+
+                _adminLock.Unlock();
+            }
+
+            void Deactivated(PluginHost::IShell&) override
+            {
+            }
+
+            void Registered() override
+            {
+                _adminLock.Lock();
+
+                _profile.Observed = Now();
+                _registered = true;
+
+                if (_reported == true) {
+                    SYSLOG(Logging::Startup, (_T("%s was active before boot profiling started, %u plugins were active after %u ms."), _profile.Target.c_str(), _active, _profile.Observed));
+                }
+
+                _adminLock.Unlock();
+            }
+
+        private:
+            void SubsystemsUpdated()
+            {
+                ASSERT(_subsystems != nullptr);
+
+                const uint32_t now = Now();
+
+                _adminLock.Lock();
+
+                for (uint32_t index = 0; index < PluginHost::ISubSystem::END_LIST; ++index) {
+                    const PluginHost::ISubSystem::subsystem which = static_cast<PluginHost::ISubSystem::subsystem>(index);
+
+                    if ((_reported == false) && (_subsystems->IsActive(which) == true) && ((_seen & (1u << index)) == 0)) {
+                        const TCHAR* name = Core::EnumerateType<PluginHost::ISubSystem::subsystem>(which).Data();
+
+                        _seen |= (1u << index);
+                        _profile.Milestones.push_back({ (name != nullptr ? string(name) : std::to_string(index)), now });
+                    }
+                }
+
+                _adminLock.Unlock();
+            }
+            // Must be called with the lock taken.
+            void Report()
+            {
+                _reported = true;
+
+                if (_registered == true) {
+                    if (_profile.Observed != 0) {
+                        // Everything before we were observing is accounted for as one step.
+                        _profile.Path.push_back({ _T("(before observation: ") + std::to_string(_active) + _T(" plugins)"), 0, _profile.Observed, 0 });
+                    }
+
+                    std::sort(_profile.Path.begin(), _profile.Path.end(), [](const BootProfile::Step& lhs, const BootProfile::Step& rhs) {
+                        return ((lhs.End - lhs.Start) > (rhs.End - rhs.Start));
+                    });
+
+                    Logger()->CriticalPath(_profile);
+                }
+            }
+
+            // ms since the framework process started.
+            uint32_t Now() const
+            {
+                struct timespec now;
+#ifdef CLOCK_BOOTTIME
+                clock_gettime(CLOCK_BOOTTIME, &now);
+#else
+                clock_gettime(CLOCK_MONOTONIC, &now);
+#endif
+                const uint64_t sinceBoot = (static_cast<uint64_t>(now.tv_sec) * 1000) + (now.tv_nsec / 1000000);
+
+                return (sinceBoot > _profile.ProcessStart ? static_cast<uint32_t>(sinceBoot - _profile.ProcessStart) : 0);
+            }
+            // ms since the framework process started that the first process of the plugin was started.
+            uint32_t Spawned(PluginHost::IShell& service) const
+            {
+                uint32_t result = 0;
+
+                Exchange::IMemoryExtended* memory = service.QueryInterface<Exchange::IMemoryExtended>();
+
+                if (memory != nullptr) {
+                    Exchange::IMemoryExtended::IStringIterator* iterator = nullptr;
+
+                    if ((memory->Processes(iterator) == Core::ERROR_NONE) && (iterator != nullptr)) {
+                        string name;
+
+                        while (iterator->Next(name) == true) {
+                            Exchange::IProcessMemory* process = nullptr;
+
+                            if ((memory->Process(name, process) == Core::ERROR_NONE) && (process != nullptr)) {
+                                const uint32_t pid = process->Identifier();
+
+                                if ((pid != 0) && (pid != static_cast<uint32_t>(getpid()))) {
+                                    const uint32_t start = StartTime(pid);
+
+                                    if ((start > _profile.ProcessStart) && ((result == 0) || ((start - _profile.ProcessStart) < result))) {
+                                        result = start - _profile.ProcessStart;
+                                    }
+                                }
+                                process->Release();
+                            }
+                        }
+                        iterator->Release();
+                    }
+                    memory->Release();
+                }
+
+                return (result);
+            }
+            // ms since boot the given process (0 for ourselves) was started.
+            static uint32_t StartTime(const uint32_t pid)
+            {
+                static const long ticks = sysconf(_SC_CLK_TCK);
+
+                uint32_t result = 0;
+                char path[32];
+
+                if (pid == 0) {
+                    snprintf(path, sizeof(path), "/proc/self/stat");
+                } else {
+                    snprintf(path, sizeof(path), "/proc/%u/stat", pid);
+                }
+
+                FILE* file = fopen(path, "r");
+
+                if (file != nullptr) {
+                    char line[512];
+
+                    if (fgets(line, sizeof(line), file) != nullptr) {
+                        // The process name might hold spaces and parentheses, the fields start after the last ')'.
+                        const char* fields = strrchr(line, ')');
+                        unsigned long long start;
+
+                        if ((fields != nullptr) && (ticks > 0) && (sscanf(fields + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu", &start) == 1)) {
+                            result = static_cast<uint32_t>((start * 1000) / ticks);
+                        }
+                    }
+                    fclose(file);
+                }
+
+                return (result);
+            }
+
+        private:
+            PluginHost::IShell& _service;
+            PluginHost::ISubSystem* _subsystems;
+            Core::SinkType<Sink> _sink;
+            BootProfile _profile;
+            uint32_t _active;
+            uint32_t _seen;
+            bool _registered;
+            bool _reported;
+            mutable Core::CriticalSection _adminLock;
         };
 
         template<class LOGGERINTERFACE = IBasicMetricsLogger>
@@ -343,13 +2243,13 @@ namespace Plugin {
                 ASSERT(_service != nullptr);
                 ASSERT(_service->Callsign() == Parent().Callsign());
 
-                Logger().Enable(*_service, Parent().Callsign());
+                Logger()->Enable(*_service, Parent().Callsign());
             }
             void Disable() override
             {
                 ASSERT(_service != nullptr);
 
-                Logger().Disable();
+                Logger()->Disable();
 
                 _service->Release();
                 _service = nullptr;
@@ -358,12 +2258,12 @@ namespace Plugin {
             void Activated(PluginHost::IShell&) override
             { 
                 _activatetime = Core::Time::Now().Ticks();
-                Logger().Activated();
+                Logger()->Activated();
             }
 
             void Deactivated(PluginHost::IShell&) override
             {
-                Logger().Deactivated(Uptime());
+                Logger()->Deactivated(Uptime());
             }
 
             uint64_t ActivateTime() const 
@@ -404,10 +2304,15 @@ namespace Plugin {
             StateObservable(const StateObservable&) = delete;
             StateObservable& operator=(const StateObservable&) = delete;
 
+PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
             StateObservable(CallsignPerfMetricsHandler& parent, PluginHost::IShell& service, PluginHost::IStateControl* statecontrol) 
             : Base(parent, service)
             , PluginHost::IStateControl::INotification()
             , _statecontrol(statecontrol)
+            , _memory(nullptr)
+            , _settle(0)
+            , _reclaim()
+            , _job(*this)
             {
                 // not very likely but it could happen that we have a Browser without StatControl
                 if (_statecontrol != nullptr) {
@@ -415,10 +2320,12 @@ namespace Plugin {
                     _statecontrol->AddRef();
                 }
             }
+POP_WARNING()
 
             ~StateObservable() override
             {
                 ASSERT(_statecontrol == nullptr);
+                ASSERT(_memory == nullptr);
             }
 
             void Enable() override
@@ -426,7 +2333,12 @@ namespace Plugin {
                 Base::Enable();
 
                 if (_statecontrol != nullptr) {
-                    
+                    _settle = Base::Parent().Sampling().Settle;
+
+                    if (_settle != 0) {
+                        _memory = Base::Service()->template QueryInterface<Exchange::IMemory>();
+                    }
+
                     _statecontrol->Register(this);
                 }
             }
@@ -440,9 +2352,17 @@ namespace Plugin {
             void StateChange(const PluginHost::IStateControl::state state) override 
             {
                 if (state == PluginHost::IStateControl::state::RESUMED) {
-                    Logger().Resumed();
+                    if (_memory != nullptr) {
+                        _job.Revoke();
+                        _reclaim.Resumed();
+                    }
+                    Logger()->Resumed();
                 } else if (state == PluginHost::IStateControl::state::SUSPENDED) {
-                    Logger().Suspended();
+                    Logger()->Suspended();
+                    if (_memory != nullptr) {
+                        _reclaim.Suspended(_memory->Resident());
+                        _job.Reschedule(Core::Time::Now().Add(_settle));
+                    }
                 }
             }
 
@@ -451,6 +2371,16 @@ namespace Plugin {
             END_INTERFACE_MAP
 
         private:
+            friend Core::ThreadPool::JobType<StateObservable<LOGGERINTERFACE>&>;
+
+            void Dispatch()
+            {
+                if (_reclaim.Pending() == true) {
+                    _reclaim.Settled(_memory->Resident());
+                    Logger()->Reclaimed(_reclaim);
+                }
+            }
+
             void Cleanup() 
             {
                 if (_statecontrol != nullptr) {
@@ -458,14 +2388,23 @@ namespace Plugin {
                     _statecontrol->Release();
                     _statecontrol = nullptr;
                 }
+                _job.Revoke();
+                if (_memory != nullptr) {
+                    _memory->Release();
+                    _memory = nullptr;
+                }
             }
 
         private:
             PluginHost::IStateControl* _statecontrol;
+            Exchange::IMemory* _memory;
+            uint16_t _settle;
+            SuspendReclaim _reclaim;
+            Core::WorkerPool::JobType<StateObservable<LOGGERINTERFACE>&> _job;
         };
 
         template<class LOGGERINTERFACE = IBrowserMetricsLogger>
-        class BrowserObservable : public StateObservable<LOGGERINTERFACE>, public Exchange::IBrowser::INotification {
+        class BrowserObservable : public StateObservable<LOGGERINTERFACE>, public Exchange::IBrowser::INotification, private LoadBenchmark::INavigator, private FrameRateSampler::ISource {
         private:
             using Base = StateObservable<LOGGERINTERFACE>;
 
@@ -477,6 +2416,7 @@ namespace Plugin {
             BrowserObservable(const BrowserObservable&) = delete;
             BrowserObservable& operator=(const BrowserObservable&) = delete;
 
+PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
             BrowserObservable(CallsignPerfMetricsHandler& parent, 
                               PluginHost::IShell& service, 
                               Exchange::IBrowser& browser,
@@ -485,9 +2425,16 @@ namespace Plugin {
             , Exchange::IBrowser::INotification()
             , _browser(&browser)
             , _nbrloaded(0)
+            , _timeline()
+            , _sampler()
+            , _benchmark(*this)
+            , _launches()
+            , _frames(*this)
+            , _visible(false)
             {
                 _browser->AddRef();
             }
+POP_WARNING()
 
             ~BrowserObservable() override 
             {
@@ -501,12 +2448,21 @@ namespace Plugin {
                 Base::Enable();
                 _browser->Register(this);
                 _nbrloaded = 0;
+                _timeline.Reset();
+                _launches.Activated();
+                _sampler.Enable(*Base::Service(), Base::Parent().Sampling());
+                _frames.Enable(Base::Parent().Sampling());
+                _benchmark.Start(Base::Parent().Benchmark());
             }
 
             void Disable() override
             {
                 ASSERT(_browser != nullptr);
+                _benchmark.Stop();
                 _browser->Unregister(this);
+                FramesSampled();
+                _frames.Disable();
+                _sampler.Disable();
                 _browser->Release();
                 _browser = nullptr;
 
@@ -523,28 +2479,79 @@ namespace Plugin {
                 if (URL != IBrowserMetricsLogger::startURL) {
                     ++_nbrloaded;
                 }
-                Logger().LoadFinished(URL, 0, true, _nbrloaded, 0);
+                Logger()->LoadFinished(URL, 0, true, _nbrloaded, 0);
+                if ((URL != IBrowserMetricsLogger::startURL) && (_timeline.Finished(URL, true) == true)) {
+                    Logger()->LoadTimeline(_timeline);
+                    const bool sampled = _sampler.Stop();
+                    if (sampled == true) {
+                        Logger()->LoadResources(_sampler);
+                    }
+                    _benchmark.Loaded(_timeline, (sampled == true ? _sampler.PeakResident() : 0));
+                    Base::Parent().Statistics().Concluded(Base::Parent().Callsign(), _launches, _timeline);
+                }
             }
             void URLChanged(const string& URL) override
             {
-                Logger().URLChange(URL, false);
+                if (URL != IBrowserMetricsLogger::startURL) {
+                    _timeline.URLChange(URL, false);
+                    _sampler.Start();
+                    FramesNavigated(URL);
+                }
+                Logger()->URLChange(URL, false);
             }
             void Hidden(const bool hidden) override
             {
-                Logger().VisibilityChange(hidden);
+                _visible = !hidden;
+                if (hidden == false) {
+                    _timeline.Visible();
+                    _frames.Start(_timeline.URL());
+                } else {
+                    FramesSampled();
+                }
+                Logger()->VisibilityChange(hidden);
             }
             void Closure() override
             {
-                Logger().PageClosure();
+                Logger()->PageClosure();
+            }
+
+        private:
+            void Navigate(const string& URL) override
+            {
+                _browser->SetURL(URL);
+            }
+            uint8_t FrameRate() const override
+            {
+                return (static_cast<uint8_t>(std::min(_browser->GetFPS(), static_cast<uint32_t>(0xFF))));
+            }
+            void FramesSampled()
+            {
+                if (_frames.Stop() == true) {
+                    Logger()->FrameRate(_frames);
+                }
+            }
+            // A navigation while visible starts a new period.
+            void FramesNavigated(const string& URL)
+            {
+                if (_visible == true) {
+                    FramesSampled();
+                    _frames.Start(URL);
+                }
             }
 
         private:
             Exchange::IBrowser* _browser;
             uint32_t _nbrloaded;
+            PageLoadTimeline _timeline;
+            PageLoadSampler _sampler;
+            LoadBenchmark _benchmark;
+            LaunchStatistics::Launches _launches;
+            FrameRateSampler _frames;
+            bool _visible;
         };
 
         template<class LOGGERINTERFACE = IBrowserMetricsLogger>
-        class WebBrowserObservable : public StateObservable<LOGGERINTERFACE>, public Exchange::IWebBrowser::INotification {
+        class WebBrowserObservable : public StateObservable<LOGGERINTERFACE>, public Exchange::IWebBrowser::INotification, private LoadBenchmark::INavigator, private FrameRateSampler::ISource {
         private:
             using Base = StateObservable<LOGGERINTERFACE>;
 
@@ -555,6 +2562,7 @@ namespace Plugin {
             WebBrowserObservable(const WebBrowserObservable&) = delete;
             WebBrowserObservable& operator=(const WebBrowserObservable&) = delete;
 
+PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
             WebBrowserObservable(CallsignPerfMetricsHandler& parent, 
                                  PluginHost::IShell& service, 
                                  Exchange::IWebBrowser& browser, 
@@ -564,9 +2572,16 @@ namespace Plugin {
             , _browser(&browser)
             , _nbrloadedsuccess(0)
             , _nbrloadedfailed(0)
+            , _timeline()
+            , _sampler()
+            , _benchmark(*this)
+            , _launches()
+            , _frames(*this)
+            , _visible(false)
             {
                 _browser->AddRef();
             }
+POP_WARNING()
 
             ~WebBrowserObservable() override 
             {
@@ -581,13 +2596,33 @@ namespace Plugin {
                 _browser->Register(this);
                 _nbrloadedsuccess = 0;
                 _nbrloadedfailed = 0;
+                _timeline.Reset();
+                _launches.Activated();
+                _sampler.Enable(*Base::Service(), Base::Parent().Sampling());
+                _frames.Enable(Base::Parent().Sampling());
+                _benchmark.Start(Base::Parent().Benchmark());
+
+                // Unlike the IBrowser, the visibility at hand can be asked for, no need to wait for a change.
+                // Through a const interface, the getters are overloaded with setters of the same name.
+                const Exchange::IWebBrowser* browser = _browser;
+                Exchange::IWebBrowser::VisibilityType visibility = Exchange::IWebBrowser::VisibilityType::HIDDEN;
+                _visible = ((browser->Visibility(visibility) == Core::ERROR_NONE) && (visibility == Exchange::IWebBrowser::VisibilityType::VISIBLE));
+                if (_visible == true) {
+                    string URL;
+                    browser->URL(URL);
+                    _frames.Start(URL);
+                }
             }
 
             void Disable() override
             {
                 ASSERT(_browser != nullptr);
 
+                _benchmark.Stop();
                 _browser->Unregister(this);
+                FramesSampled();
+                _frames.Disable();
+                _sampler.Disable();
                 _browser->Release();
                 _browser = nullptr;
 
@@ -604,35 +2639,259 @@ namespace Plugin {
                 if (URL != IBrowserMetricsLogger::startURL) {
                     ++_nbrloadedsuccess;
                 }
-                Logger().LoadFinished(URL, httpstatus, true, _nbrloadedsuccess, _nbrloadedfailed);
+                Logger()->LoadFinished(URL, httpstatus, true, _nbrloadedsuccess, _nbrloadedfailed);
+                if ((URL != IBrowserMetricsLogger::startURL) && (_timeline.Finished(URL, true) == true)) {
+                    Logger()->LoadTimeline(_timeline);
+                    const bool sampled = _sampler.Stop();
+                    if (sampled == true) {
+                        Logger()->LoadResources(_sampler);
+                    }
+                    _benchmark.Loaded(_timeline, (sampled == true ? _sampler.PeakResident() : 0));
+                    Base::Parent().Statistics().Concluded(Base::Parent().Callsign(), _launches, _timeline);
+                }
             }
             void LoadFailed(const string& URL) override
             {
                 if (URL != IBrowserMetricsLogger::startURL) {
                     ++_nbrloadedfailed;
                 }
-                Logger().LoadFinished(URL, 0, false, _nbrloadedsuccess, _nbrloadedfailed);
+                Logger()->LoadFinished(URL, 0, false, _nbrloadedsuccess, _nbrloadedfailed);
+                if ((URL != IBrowserMetricsLogger::startURL) && (_timeline.Finished(URL, false) == true)) {
+                    Logger()->LoadTimeline(_timeline);
+                    const bool sampled = _sampler.Stop();
+                    if (sampled == true) {
+                        Logger()->LoadResources(_sampler);
+                    }
+                    _benchmark.Loaded(_timeline, (sampled == true ? _sampler.PeakResident() : 0));
+                    Base::Parent().Statistics().Concluded(Base::Parent().Callsign(), _launches, _timeline);
+                }
             }
             void URLChange(const string& URL, const bool loaded) override
             {
-                Logger().URLChange(URL, loaded);
+                if (URL != IBrowserMetricsLogger::startURL) {
+                    _timeline.URLChange(URL, loaded);
+                    if (loaded == false) {
+                        _sampler.Start();
+                        FramesNavigated(URL);
+                    }
+                }
+                Logger()->URLChange(URL, loaded);
             }
             void VisibilityChange(const bool hidden) override
             {
-                Logger().VisibilityChange(hidden);
+                _visible = !hidden;
+                if (hidden == false) {
+                    _timeline.Visible();
+                    _frames.Start(_timeline.URL());
+                } else {
+                    FramesSampled();
+                }
+                Logger()->VisibilityChange(hidden);
             }
             void PageClosure() override
             {
-                Logger().PageClosure();
+                Logger()->PageClosure();
             }
             void BridgeQuery(const string&) override
             {
             }
 
+        private:
+            void Navigate(const string& URL) override
+            {
+                _browser->URL(URL);
+            }
+            uint8_t FrameRate() const override
+            {
+                uint8_t fps = 0;
+                _browser->FPS(fps);
+                return (fps);
+            }
+            void FramesSampled()
+            {
+                if (_frames.Stop() == true) {
+                    Logger()->FrameRate(_frames);
+                }
+            }
+            // A navigation while visible starts a new period.
+            void FramesNavigated(const string& URL)
+            {
+                if (_visible == true) {
+                    FramesSampled();
+                    _frames.Start(URL);
+                }
+            }
+
         private:
             Exchange::IWebBrowser* _browser;
             uint32_t _nbrloadedsuccess;
             uint32_t _nbrloadedfailed;
+            PageLoadTimeline _timeline;
+            PageLoadSampler _sampler;
+            LoadBenchmark _benchmark;
+            LaunchStatistics::Launches _launches;
+            FrameRateSampler _frames;
+            bool _visible;
+        };
+
+    public:
+        class LaunchInfo : public Core::JSON::Container {
+        public:
+            class Figures : public Core::JSON::Container {
+            public:
+                Figures& operator=(const Figures&) = delete;
+
+                Figures()
+                    : Core::JSON::Container()
+                    , Count()
+                    , P50()
+                    , P95()
+                {
+                    Add(_T("count"), &Count);
+                    Add(_T("p50"), &P50);
+                    Add(_T("p95"), &P95);
+                }
+                Figures(const Figures& copy)
+                    : Core::JSON::Container()
+                    , Count(copy.Count)
+                    , P50(copy.P50)
+                    , P95(copy.P95)
+                {
+                    Add(_T("count"), &Count);
+                    Add(_T("p50"), &P50);
+                    Add(_T("p95"), &P95);
+                }
+                ~Figures() override = default;
+
+                void Values(const LaunchStatistics::Histogram& histogram)
+                {
+                    Count = histogram.Count();
+                    P50 = histogram.Percentile(50);
+                    P95 = histogram.Percentile(95);
+                }
+
+            public:
+                Core::JSON::DecUInt32 Count;
+                Core::JSON::DecUInt32 P50; // ms
+                Core::JSON::DecUInt32 P95; // ms
+            };
+
+        public:
+            LaunchInfo& operator=(const LaunchInfo&) = delete;
+
+            LaunchInfo()
+                : Core::JSON::Container()
+                , Callsign()
+                , Cold()
+                , Warm()
+                , FirstLoad()
+            {
+                Init();
+            }
+            LaunchInfo(const LaunchInfo& copy)
+                : Core::JSON::Container()
+                , Callsign(copy.Callsign)
+                , Cold(copy.Cold)
+                , Warm(copy.Warm)
+                , FirstLoad(copy.FirstLoad)
+            {
+                Init();
+            }
+            ~LaunchInfo() override = default;
+
+        private:
+            void Init()
+            {
+                Add(_T("callsign"), &Callsign);
+                Add(_T("cold"), &Cold);
+                Add(_T("warm"), &Warm);
+                Add(_T("firstload"), &FirstLoad);
+            }
+
+        public:
+            Core::JSON::String Callsign;
+            Figures Cold;
+            Figures Warm;
+            Figures FirstLoad;
+        };
+
+        class MetricInfo : public Core::JSON::Container {
+        public:
+            MetricInfo& operator=(const MetricInfo&) = delete;
+
+            MetricInfo()
+                : Core::JSON::Container()
+                , Registry()
+                , Name()
+                , Type()
+                , Value()
+                , Sum()
+                , Buckets()
+            {
+                Init();
+            }
+            MetricInfo(const MetricInfo& copy)
+                : Core::JSON::Container()
+                , Registry(copy.Registry)
+                , Name(copy.Name)
+                , Type(copy.Type)
+                , Value(copy.Value)
+                , Sum(copy.Sum)
+                , Buckets(copy.Buckets)
+            {
+                Init();
+            }
+            ~MetricInfo() override = default;
+
+            void Values(const string& registry, const Metrics::Value& value)
+            {
+                Registry = registry;
+                Name = value.Name;
+                Value = value.Total;
+
+                switch (value.Type) {
+                case Metrics::type::COUNTER:
+                    Type = _T("counter");
+                    break;
+                case Metrics::type::GAUGE:
+                    Type = _T("gauge");
+                    break;
+                case Metrics::type::HISTOGRAM: {
+                    Type = _T("histogram");
+                    Sum = value.Sum;
+                    // Bucket n holds the values in [2^(n-1), 2^n), bucket 0 the zeroes; trailing empty buckets are left out.
+                    uint8_t used = Metrics::HistogramBuckets;
+                    while ((used > 0) && (value.Buckets[used - 1] == 0)) {
+                        used--;
+                    }
+                    for (uint8_t index = 0; index < used; index++) {
+                        Buckets.Add() = value.Buckets[index];
+                    }
+                    break;
+                }
+                default:
+                    break;
+                }
+            }
+
+        private:
+            void Init()
+            {
+                Add(_T("registry"), &Registry);
+                Add(_T("name"), &Name);
+                Add(_T("type"), &Type);
+                Add(_T("value"), &Value);
+                Add(_T("sum"), &Sum);
+                Add(_T("buckets"), &Buckets);
+            }
+
+        public:
+            Core::JSON::String Registry;
+            Core::JSON::String Name;
+            Core::JSON::String Type;
+            Core::JSON::DecUInt64 Value; // counter or gauge value, number of values recorded in a histogram
+            Core::JSON::DecUInt64 Sum;
+            Core::JSON::ArrayType<Core::JSON::DecUInt64> Buckets;
         };
 
     public:
@@ -640,8 +2899,10 @@ namespace Plugin {
 PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
         PerformanceMetrics()
         : PluginHost::IPlugin()
+        , PluginHost::JSONRPC()
         , _notification(*this)
         , _handler()
+        , _statistics()
         {
         }
 POP_WARNING()
@@ -652,6 +2913,7 @@ POP_WARNING()
 
         BEGIN_INTERFACE_MAP(PerformanceMetrics)
         INTERFACE_ENTRY(PluginHost::IPlugin)
+        INTERFACE_ENTRY(PluginHost::IDispatcher)
         END_INTERFACE_MAP
 
     public:
@@ -681,9 +2943,15 @@ POP_WARNING()
         void PluginActivated(PluginHost::IShell& service);
         void PluginDeactivated(PluginHost::IShell& service);
 
+        void RegisterAll();
+        void UnregisterAll();
+        uint32_t get_launches(const string& index, Core::JSON::ArrayType<LaunchInfo>& response) const;
+        uint32_t get_metrics(const string& index, Core::JSON::ArrayType<MetricInfo>& response) const;
+
     private:
         Core::SinkType<Notification> _notification;
         std::unique_ptr<IPerfMetricsHandler> _handler;
+        LaunchStatistics _statistics;
     };
 
 }
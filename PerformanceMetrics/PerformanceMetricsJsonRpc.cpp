@@ -0,0 +1,103 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Module.h"
+#include "PerformanceMetrics.h"
+
+namespace Thunder {
+
+namespace Plugin {
+
+    // Registration
+    //
+
+    void PerformanceMetrics::RegisterAll()
+    {
+        Property<Core::JSON::ArrayType<LaunchInfo>>(_T("launches"), &PerformanceMetrics::get_launches, nullptr, this);
+        Property<Core::JSON::ArrayType<MetricInfo>>(_T("metrics"), &PerformanceMetrics::get_metrics, nullptr, this);
+    }
+
+    void PerformanceMetrics::UnregisterAll()
+    {
+        Unregister(_T("launches"));
+        Unregister(_T("metrics"));
+    }
+
+    // API implementation
+    //
+
+    // Property: launches - Launch time percentiles either for a single browser or all browsers observed so far
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNKNOWN_KEY: Nothing was recorded for the callsign
+    uint32_t PerformanceMetrics::get_launches(const string& index, Core::JSON::ArrayType<LaunchInfo>& response) const
+    {
+        std::map<string, LaunchStatistics::Histograms> histograms;
+
+        _statistics.Snapshot(index, histograms);
+
+        for (const auto& entry : histograms) {
+            LaunchInfo& info(response.Add());
+
+            info.Callsign = entry.first;
+            info.Cold.Values(entry.second[LaunchStatistics::COLD]);
+            info.Warm.Values(entry.second[LaunchStatistics::WARM]);
+            info.FirstLoad.Values(entry.second[LaunchStatistics::FIRSTLOAD]);
+        }
+
+        return ((index.empty() == false) && (histograms.empty() == true) ? Core::ERROR_UNKNOWN_KEY : Core::ERROR_NONE);
+    }
+
+    // Property: metrics - Values published by the processes to the shared memory metrics registries, either of a
+    // single registry or of all of them
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNKNOWN_KEY: There is no registry by that name
+    uint32_t PerformanceMetrics::get_metrics(const string& index, Core::JSON::ArrayType<MetricInfo>& response) const
+    {
+        std::vector<std::string> names;
+        std::vector<Metrics::Value> values;
+        bool found = false;
+
+        Metrics::Registry::Registries(names);
+
+        for (const std::string& name : names) {
+            if ((index.empty() == true) || (index == name)) {
+                Metrics::Registry registry;
+
+                if (registry.Attach(name) == true) {
+                    found = true;
+
+                    registry.Values(values);
+
+                    for (const Metrics::Value& value : values) {
+                        response.Add().Values(name, value);
+                    }
+
+                    values.clear();
+                }
+            }
+        }
+
+        return ((index.empty() == false) && (found == false) ? Core::ERROR_UNKNOWN_KEY : Core::ERROR_NONE);
+    }
+
+} // namespace Plugin
+
+} // namespace Thunder
@@ -241,6 +241,174 @@ private:
             Core::JSON::String Callsign;
     };
 
+    class TimelineAsJson : public Core::JSON::Container {
+        public:
+
+            TimelineAsJson()
+                : Core::JSON::Container()
+                , Origin()
+                , LoadSuccess()
+                , Committed()
+                , Visible()
+                , Finished()
+                , OriginLoads()
+                , OriginFailures()
+                , OriginCommitted()
+                , OriginFinished()
+                , Callsign()
+            {
+                Add(_T("Origin"), &Origin);
+                Add(_T("LoadSuccess"), &LoadSuccess);
+                Add(_T("Committed"), &Committed);
+                Add(_T("Visible"), &Visible);
+                Add(_T("Finished"), &Finished);
+                Add(_T("OriginLoads"), &OriginLoads);
+                Add(_T("OriginFailures"), &OriginFailures);
+                Add(_T("OriginAvgCommitted"), &OriginCommitted);
+                Add(_T("OriginAvgFinished"), &OriginFinished);
+                Add(_T("CallSign"), &Callsign);
+            }
+            ~TimelineAsJson() override = default;
+
+            TimelineAsJson(const TimelineAsJson&) = delete;
+            TimelineAsJson& operator=(const TimelineAsJson&) = delete;
+
+        public:
+            Core::JSON::String Origin;
+            Core::JSON::DecUInt8 LoadSuccess;
+            Core::JSON::DecUInt32 Committed;
+            Core::JSON::DecUInt32 Visible;
+            Core::JSON::DecUInt32 Finished;
+            Core::JSON::DecUInt32 OriginLoads;
+            Core::JSON::DecUInt32 OriginFailures;
+            Core::JSON::DecUInt32 OriginCommitted;
+            Core::JSON::DecUInt32 OriginFinished;
+            Core::JSON::String Callsign;
+    };
+
+    class ResourcesAsJson : public Core::JSON::Container {
+        public:
+
+            ResourcesAsJson()
+                : Core::JSON::Container()
+                , Samples()
+                , Duration()
+                , PeakRSS()
+                , AverageRSS()
+                , IntegratedRSS()
+                , CPUTime()
+                , PeakCPU()
+                , Callsign()
+            {
+                Add(_T("Samples"), &Samples);
+                Add(_T("Duration"), &Duration);
+                Add(_T("PeakRSS"), &PeakRSS);
+                Add(_T("AvgRSS"), &AverageRSS);
+                Add(_T("IntegratedRSS"), &IntegratedRSS);
+                Add(_T("CPUTime"), &CPUTime);
+                Add(_T("PeakCPU"), &PeakCPU);
+                Add(_T("CallSign"), &Callsign);
+            }
+            ~ResourcesAsJson() override = default;
+
+            ResourcesAsJson(const ResourcesAsJson&) = delete;
+            ResourcesAsJson& operator=(const ResourcesAsJson&) = delete;
+
+        public:
+            Core::JSON::DecUInt32 Samples;
+            Core::JSON::DecUInt32 Duration; // ms
+            Core::JSON::DecUInt64 PeakRSS; // KB
+            Core::JSON::DecUInt64 AverageRSS; // KB
+            Core::JSON::DecUInt64 IntegratedRSS; // KB * s
+            Core::JSON::DecUInt32 CPUTime; // ms
+            Core::JSON::DecUInt32 PeakCPU; // % of one core
+            Core::JSON::String Callsign;
+    };
+
+    class FrameRateAsJson : public Core::JSON::Container {
+        public:
+
+            FrameRateAsJson()
+                : Core::JSON::Container()
+                , URL()
+                , Seconds()
+                , Target()
+                , Average()
+                , Minimum()
+                , Dropped()
+                , Janky()
+                , Histogram()
+                , Callsign()
+            {
+                Add(_T("URL"), &URL);
+                Add(_T("Seconds"), &Seconds);
+                Add(_T("Target"), &Target);
+                Add(_T("AvgFPS"), &Average);
+                Add(_T("MinFPS"), &Minimum);
+                Add(_T("Dropped"), &Dropped);
+                Add(_T("Janky"), &Janky);
+                Add(_T("Histogram"), &Histogram);
+                Add(_T("CallSign"), &Callsign);
+            }
+            ~FrameRateAsJson() override = default;
+
+            FrameRateAsJson(const FrameRateAsJson&) = delete;
+            FrameRateAsJson& operator=(const FrameRateAsJson&) = delete;
+
+        public:
+            Core::JSON::String URL;
+            Core::JSON::DecUInt32 Seconds;
+            Core::JSON::DecUInt8 Target; // fps
+            Core::JSON::DecUInt32 Average; // fps
+            Core::JSON::DecUInt32 Minimum; // fps
+            Core::JSON::DecUInt64 Dropped; // frames
+            Core::JSON::DecUInt32 Janky; // s
+            Core::JSON::ArrayType<Core::JSON::DecUInt32> Histogram; // s per 5 fps
+            Core::JSON::String Callsign;
+    };
+
+    class ReclaimAsJson : public Core::JSON::Container {
+        public:
+
+            ReclaimAsJson()
+                : Core::JSON::Container()
+                , BeforeRSS()
+                , SettledRSS()
+                , Reclaimed()
+                , Suspends()
+                , Interrupted()
+                , AverageReclaimed()
+                , PeakReclaimed()
+                , SuspendedTime()
+                , Callsign()
+            {
+                Add(_T("BeforeRSS"), &BeforeRSS);
+                Add(_T("SettledRSS"), &SettledRSS);
+                Add(_T("Reclaimed"), &Reclaimed);
+                Add(_T("Suspends"), &Suspends);
+                Add(_T("Interrupted"), &Interrupted);
+                Add(_T("AvgReclaimed"), &AverageReclaimed);
+                Add(_T("PeakReclaimed"), &PeakReclaimed);
+                Add(_T("SuspendedTime"), &SuspendedTime);
+                Add(_T("CallSign"), &Callsign);
+            }
+            ~ReclaimAsJson() override = default;
+
+            ReclaimAsJson(const ReclaimAsJson&) = delete;
+            ReclaimAsJson& operator=(const ReclaimAsJson&) = delete;
+
+        public:
+            Core::JSON::DecUInt64 BeforeRSS; // KB
+            Core::JSON::DecUInt64 SettledRSS; // KB
+            Core::JSON::DecUInt64 Reclaimed; // KB
+            Core::JSON::DecUInt32 Suspends;
+            Core::JSON::DecUInt32 Interrupted;
+            Core::JSON::DecUInt64 AverageReclaimed; // KB
+            Core::JSON::DecUInt64 PeakReclaimed; // KB
+            Core::JSON::DecUInt64 SuspendedTime; // s
+            Core::JSON::String Callsign;
+    };
+
 public:
     SysLogOuput(const SysLogOuput&) = delete;
     SysLogOuput& operator=(const SysLogOuput&) = delete;
@@ -344,6 +512,26 @@ public:
         _timeIdleFirstStart = Core::Time::Now().Ticks();
     }
 
+    void Reclaimed(const PerformanceMetrics::SuspendReclaim& reclaim) override
+    {
+        ReclaimAsJson output;
+
+        output.BeforeRSS = reclaim.Before() / 1024;
+        output.SettledRSS = reclaim.After() / 1024;
+        output.Reclaimed = reclaim.Reclaimed() / 1024;
+        output.Suspends = reclaim.Suspends();
+        output.Interrupted = reclaim.Interrupted();
+        output.AverageReclaimed = reclaim.AverageReclaimed() / 1024;
+        output.PeakReclaimed = reclaim.PeakReclaimed() / 1024;
+        output.SuspendedTime = reclaim.SuspendedTime() / 1000;
+        output.Callsign = _callsign;
+
+        string outputstring;
+        output.ToString(outputstring);
+
+        SYSLOG(Logging::Notification, (_T( "%s Suspend Reclaim: %s "), _callsign.c_str(), outputstring.c_str()));
+    }
+
     string getHostName(string _URL){
         std::size_t startIdx = _URL.find("://");
         if (startIdx == std::string::npos) {
@@ -427,6 +615,80 @@ public:
     void PageClosure() override 
     {
     }
+
+    void LoadTimeline(const PerformanceMetrics::PageLoadTimeline& timeline) override
+    {
+        using Timeline = PerformanceMetrics::PageLoadTimeline;
+
+        TimelineAsJson output;
+
+        // Phases not seen are left out, a 0 would read as "instantly".
+        output.Origin = timeline.Origin();
+        output.LoadSuccess = timeline.Success();
+        if (timeline.Phase(Timeline::COMMITTED) != 0) {
+            output.Committed = timeline.Phase(Timeline::COMMITTED);
+        }
+        if (timeline.Phase(Timeline::VISIBLE) != 0) {
+            output.Visible = timeline.Phase(Timeline::VISIBLE);
+        }
+        output.Finished = timeline.Phase(Timeline::FINISHED);
+
+        const Timeline::Aggregate& origin(timeline.Statistics());
+        output.OriginLoads = origin.Loads();
+        output.OriginFailures = origin.Failures();
+        if (origin.Average(Timeline::COMMITTED) != 0) {
+            output.OriginCommitted = origin.Average(Timeline::COMMITTED);
+        }
+        output.OriginFinished = origin.Average(Timeline::FINISHED);
+        output.Callsign = _callsign;
+
+        string outputstring;
+        output.ToString(outputstring);
+
+        SYSLOG(Logging::Notification, (_T( "%s Page Load Timeline: %s "), _callsign.c_str(), outputstring.c_str()));
+    }
+
+    void LoadResources(const PerformanceMetrics::PageLoadSampler& sampler) override
+    {
+        ResourcesAsJson output;
+
+        output.Samples = sampler.Samples();
+        output.Duration = sampler.Last().Time;
+        output.PeakRSS = sampler.PeakResident() / 1024;
+        output.AverageRSS = sampler.AverageResident() / 1024;
+        output.IntegratedRSS = sampler.IntegratedResident();
+        output.CPUTime = sampler.CPUTime();
+        output.PeakCPU = sampler.PeakCPU();
+        output.Callsign = _callsign;
+
+        string outputstring;
+        output.ToString(outputstring);
+
+        SYSLOG(Logging::Notification, (_T( "%s Page Load Resources: %s "), _callsign.c_str(), outputstring.c_str()));
+    }
+
+    void FrameRate(const PerformanceMetrics::FrameRateSampler& sampler) override
+    {
+        FrameRateAsJson output;
+
+        output.URL = getHostName(sampler.URL());
+        output.Seconds = sampler.Seconds();
+        output.Target = sampler.Target();
+        output.Average = sampler.Average();
+        output.Minimum = sampler.Minimum();
+        output.Dropped = sampler.Dropped();
+        output.Janky = sampler.Janky();
+        for (uint8_t index = 0; index < PerformanceMetrics::FrameRateSampler::Buckets; index++) {
+            output.Histogram.Add() = sampler.Bucket(index);
+        }
+        output.Callsign = _callsign;
+
+        string outputstring;
+        output.ToString(outputstring);
+
+        SYSLOG(Logging::Notification, (_T( "%s Frame Rate: %s "), _callsign.c_str(), outputstring.c_str()));
+    }
+
 private:
     void OutputLoadFinishedMetrics(const URLLoadedMetrics& urloadedmetrics, 
                                    const string& URL, 
@@ -521,11 +783,47 @@ private:
 
 constexpr char SysLogOuput::webProcessName[];
 
+class SysLogBootOutput : public PerformanceMetrics::IBootMetricsLogger {
+public:
+    SysLogBootOutput(const SysLogBootOutput&) = delete;
+    SysLogBootOutput& operator=(const SysLogBootOutput&) = delete;
+
+    SysLogBootOutput() = default;
+    ~SysLogBootOutput() override = default;
+
+    void CriticalPath(const PerformanceMetrics::BootProfile& profile) override
+    {
+        SYSLOG(Logging::Notification, (_T("Boot critical path: %s ready %u ms after the framework started (%u ms after boot)"),
+                                       profile.Target.c_str(), profile.Ready, profile.ProcessStart + profile.Ready));
+
+        for (const PerformanceMetrics::BootProfile::Step& step : profile.Path) {
+            const uint32_t duration = step.End - step.Start;
+
+            if (step.Spawned != 0) {
+                SYSLOG(Logging::Notification, (_T("  %s: %u ms (%u%%), %u - %u ms, process spawned at %u ms"), step.Callsign.c_str(), duration,
+                                               (profile.Ready != 0 ? (duration * 100) / profile.Ready : 0), step.Start, step.End, step.Spawned));
+            } else {
+                SYSLOG(Logging::Notification, (_T("  %s: %u ms (%u%%), %u - %u ms"), step.Callsign.c_str(), duration,
+                                               (profile.Ready != 0 ? (duration * 100) / profile.Ready : 0), step.Start, step.End));
+            }
+        }
+
+        for (const PerformanceMetrics::BootProfile::Milestone& milestone : profile.Milestones) {
+            SYSLOG(Logging::Notification, (_T("  subsystem %s active at %u ms"), milestone.Name.c_str(), milestone.Time));
+        }
+    }
+};
+
 template<class LOGGERINTERFACE>
 std::unique_ptr<LOGGERINTERFACE> PerformanceMetrics::LoggerFactory() {
     return std::unique_ptr<LOGGERINTERFACE>(new SysLogOuput());
 }
 
+template<>
+std::unique_ptr<PerformanceMetrics::IBootMetricsLogger> PerformanceMetrics::LoggerFactory<PerformanceMetrics::IBootMetricsLogger>() {
+    return std::unique_ptr<PerformanceMetrics::IBootMetricsLogger>(new SysLogBootOutput());
+}
+
 template std::unique_ptr<PerformanceMetrics::IBasicMetricsLogger> PerformanceMetrics::LoggerFactory<PerformanceMetrics::IBasicMetricsLogger>();                
 template std::unique_ptr<PerformanceMetrics::IStateMetricsLogger> PerformanceMetrics::LoggerFactory<PerformanceMetrics::IStateMetricsLogger>();                
 template std::unique_ptr<PerformanceMetrics::IBrowserMetricsLogger> PerformanceMetrics::LoggerFactory<PerformanceMetrics::IBrowserMetricsLogger>();                
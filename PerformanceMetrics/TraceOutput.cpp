@@ -123,6 +123,19 @@ public:
         }
     }
 
+    void Reclaimed(const PerformanceMetrics::SuspendReclaim& reclaim) override
+    {
+        TRACE(Trace::Metric, (_T("Plugin %s reclaimed after suspend: %llu (RSS %llu -> %llu), suspends[%u] interrupted[%u], average reclaimed: %llu, peak reclaimed: %llu"),
+                                    _callsign.c_str(),
+                                    reclaim.Reclaimed(),
+                                    reclaim.Before(),
+                                    reclaim.After(),
+                                    reclaim.Suspends(),
+                                    reclaim.Interrupted(),
+                                    reclaim.AverageReclaimed(),
+                                    reclaim.PeakReclaimed()));
+    }
+
 private:
     string _callsign;
     Exchange::IMemory* _memory;
@@ -180,6 +193,19 @@ public:
         TRACE(Trace::Metric, (_T("Browser %s suspended, RSS: %llu"), _callsign.c_str(), rss));
     }
 
+    void Reclaimed(const PerformanceMetrics::SuspendReclaim& reclaim) override
+    {
+        TRACE(Trace::Metric, (_T("Plugin %s reclaimed after suspend: %llu (RSS %llu -> %llu), suspends[%u] interrupted[%u], average reclaimed: %llu, peak reclaimed: %llu"),
+                                    _callsign.c_str(),
+                                    reclaim.Reclaimed(),
+                                    reclaim.Before(),
+                                    reclaim.After(),
+                                    reclaim.Suspends(),
+                                    reclaim.Interrupted(),
+                                    reclaim.AverageReclaimed(),
+                                    reclaim.PeakReclaimed()));
+    }
+
     void LoadFinished(const string& URL, const int32_t, const bool success, const uint32_t totalsuccess, const uint32_t totalfailed) override 
     {
         if( ( URL != startURL ) ) {
@@ -209,11 +235,79 @@ public:
     {
     }
 
+    void LoadTimeline(const PerformanceMetrics::PageLoadTimeline& timeline) override
+    {
+        using Timeline = PerformanceMetrics::PageLoadTimeline;
+
+        const Timeline::Aggregate& origin(timeline.Statistics());
+
+        TRACE(Trace::Metric, (_T("Browser %s page load timeline [%s] %s, committed(ms): %u, visible(ms): %u, finished(ms): %u, origin loads[%u] failures[%u] average finished(ms): %u"),
+                                    _callsign.c_str(),
+                                    timeline.Origin().c_str(),
+                                    (timeline.Success() == true ? _T("successfully") : _T("unsuccessfully")),
+                                    timeline.Phase(Timeline::COMMITTED),
+                                    timeline.Phase(Timeline::VISIBLE),
+                                    timeline.Phase(Timeline::FINISHED),
+                                    origin.Loads(),
+                                    origin.Failures(),
+                                    origin.Average(Timeline::FINISHED)));
+    }
+
+    void LoadResources(const PerformanceMetrics::PageLoadSampler& sampler) override
+    {
+        TRACE(Trace::Metric, (_T("Browser %s page load resources, samples[%u] over %u ms, peak RSS: %llu, average RSS: %llu, integrated RSS(KB*s): %llu, CPU time(ms): %u, peak CPU(%%): %u"),
+                                    _callsign.c_str(),
+                                    sampler.Samples(),
+                                    sampler.Last().Time,
+                                    sampler.PeakResident(),
+                                    sampler.AverageResident(),
+                                    sampler.IntegratedResident(),
+                                    sampler.CPUTime(),
+                                    sampler.PeakCPU()));
+    }
+
+    void FrameRate(const PerformanceMetrics::FrameRateSampler& sampler) override
+    {
+        TRACE(Trace::Metric, (_T("Browser %s frame rate [%s] over %u s, average fps: %u, minimum fps: %u, dropped frames: %llu, janky seconds: %u (target %u fps)"),
+                                    _callsign.c_str(),
+                                    sampler.URL().c_str(),
+                                    sampler.Seconds(),
+                                    sampler.Average(),
+                                    sampler.Minimum(),
+                                    sampler.Dropped(),
+                                    sampler.Janky(),
+                                    sampler.Target()));
+    }
+
 private:
     string _callsign;
     Exchange::IMemory* _memory;
 };
 
+class MetricsTraceOuputBoot : public PerformanceMetrics::IBootMetricsLogger {
+public:
+    MetricsTraceOuputBoot(const MetricsTraceOuputBoot&) = delete;
+    MetricsTraceOuputBoot& operator=(const MetricsTraceOuputBoot&) = delete;
+
+    MetricsTraceOuputBoot() = default;
+    ~MetricsTraceOuputBoot() override = default;
+
+    void CriticalPath(const PerformanceMetrics::BootProfile& profile) override
+    {
+        TRACE(Trace::Metric, (_T("Boot critical path: %s ready %u ms after the framework started (%u ms after boot)"),
+                                    profile.Target.c_str(), profile.Ready, profile.ProcessStart + profile.Ready));
+
+        for (const PerformanceMetrics::BootProfile::Step& step : profile.Path) {
+            TRACE(Trace::Metric, (_T("Boot step %s: %u ms, %u - %u ms, process spawned at %u ms"),
+                                        step.Callsign.c_str(), (step.End - step.Start), step.Start, step.End, step.Spawned));
+        }
+
+        for (const PerformanceMetrics::BootProfile::Milestone& milestone : profile.Milestones) {
+            TRACE(Trace::Metric, (_T("Boot subsystem %s active at %u ms"), milestone.Name.c_str(), milestone.Time));
+        }
+    }
+};
+
 template<class LOGGERINTERFACE>
 std::unique_ptr<LOGGERINTERFACE> PerformanceMetrics::LoggerFactory() {
     return std::unique_ptr<LOGGERINTERFACE>(new MetricsTraceOuput());
@@ -224,6 +318,11 @@ std::unique_ptr<PerformanceMetrics::IBrowserMetricsLogger> PerformanceMetrics::L
     return std::unique_ptr<PerformanceMetrics::IBrowserMetricsLogger>(new MetricsTraceOuputBrowser());
 }
 
+template<>
+std::unique_ptr<PerformanceMetrics::IBootMetricsLogger> PerformanceMetrics::LoggerFactory<PerformanceMetrics::IBootMetricsLogger>() {
+    return std::unique_ptr<PerformanceMetrics::IBootMetricsLogger>(new MetricsTraceOuputBoot());
+}
+
 template std::unique_ptr<PerformanceMetrics::IBasicMetricsLogger> PerformanceMetrics::LoggerFactory<PerformanceMetrics::IBasicMetricsLogger>();                
 template std::unique_ptr<PerformanceMetrics::IStateMetricsLogger> PerformanceMetrics::LoggerFactory<PerformanceMetrics::IStateMetricsLogger>();                
 